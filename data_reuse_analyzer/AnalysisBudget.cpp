@@ -0,0 +1,66 @@
+#include <AnalysisBudget.hpp>
+#include <isl/options.h>
+#include <chrono>
+using namespace std;
+
+void WatchAnalysisBudget(AnalysisBudget* budget);
+
+AnalysisBudget* StartAnalysisBudget(isl_ctx* ctx, double timeout,
+	unsigned long maxOperations) {
+	AnalysisBudget* budget = new AnalysisBudget;
+	budget->ctx = ctx;
+	budget->timeout = timeout;
+	budget->stopped = false;
+	budget->timedOut = false;
+
+	/* The isl operations that fail once the budget is exceeded are expected.
+	They are not reported. */
+	budget->onError = isl_options_get_on_error(ctx);
+	isl_options_set_on_error(ctx, ISL_ON_ERROR_CONTINUE);
+	isl_ctx_reset_error(ctx);
+	isl_ctx_reset_operations(ctx);
+	isl_ctx_set_max_operations(ctx, maxOperations);
+
+	if (timeout > 0) {
+		budget->watchdog = thread(WatchAnalysisBudget, budget);
+	}
+
+	return budget;
+}
+
+void WatchAnalysisBudget(AnalysisBudget* budget) {
+	unique_lock<mutex> lock(budget->mutex);
+	chrono::duration<double> timeout(budget->timeout);
+	if (!budget->stop.wait_for(lock, timeout,
+		[budget] { return budget->stopped; })) {
+		budget->timedOut = true;
+		isl_ctx_abort(budget->ctx);
+	}
+}
+
+bool StopAnalysisBudget(AnalysisBudget* budget) {
+	/* Returns whether the budget was exceeded. The isl_ctx is made usable
+	again in either case. */
+	{
+		lock_guard<mutex> lock(budget->mutex);
+		budget->stopped = true;
+	}
+
+	budget->stop.notify_one();
+	if (budget->watchdog.joinable()) {
+		budget->watchdog.join();
+	}
+
+	isl_ctx* ctx = budget->ctx;
+	bool exceeded = budget->timedOut ||
+		isl_ctx_last_error(ctx) == isl_error_quota ||
+		isl_ctx_last_error(ctx) == isl_error_abort;
+
+	isl_ctx_resume(ctx);
+	isl_ctx_reset_error(ctx);
+	isl_ctx_set_max_operations(ctx, 0);
+	isl_options_set_on_error(ctx, budget->onError);
+
+	delete budget;
+	return exceeded;
+}
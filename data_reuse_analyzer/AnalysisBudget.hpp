@@ -0,0 +1,31 @@
+#ifndef ANALYSIS_BUDGET_HPP
+#define ANALYSIS_BUDGET_HPP
+
+#include <isl/ctx.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* Bounds the wall time and the number of isl operations spent on the analysis
+of one dependence in an isl_ctx. When the time runs out, the isl_ctx is
+aborted, and its isl operations fail from the next one on, as they do once the
+maximal number of operations is reached. The counting in barvinok itself is
+not interrupted; it ends at its next isl operation. */
+struct AnalysisBudget {
+	isl_ctx* ctx;
+	double timeout; // in seconds, zero for no limit
+	int onError;
+	bool stopped;
+	bool timedOut;
+	std::mutex mutex;
+	std::condition_variable stop;
+	std::thread watchdog;
+};
+
+typedef struct AnalysisBudget AnalysisBudget;
+
+AnalysisBudget* StartAnalysisBudget(isl_ctx* ctx, double timeout,
+	unsigned long maxOperations);
+bool StopAnalysisBudget(AnalysisBudget* budget);
+
+#endif
@@ -0,0 +1,154 @@
+#include <AnalysisCache.hpp>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <thread>
+using namespace std;
+
+#define ANALYSIS_CACHE_VERSION "polyscientist-cache-v9"
+
+unsigned long long ComputeFNV1aHash(vector<string> *keyParts,
+	unsigned long long hash);
+string GetAnalysisCacheEntryFileName(string cacheDir, string key);
+void CreateAnalysisCacheDirectory(string cacheDir);
+
+string ComputeAnalysisCacheKey(vector<string> *keyParts) {
+	/* Two 64-bit FNV-1a hashes with different offset bases are combined into
+	a 128-bit key. The version of the cache format is a part of the key so that
+	entries written in an older format are never read. */
+	vector<string> versionedKeyParts;
+	versionedKeyParts.push_back(ANALYSIS_CACHE_VERSION);
+	versionedKeyParts.insert(versionedKeyParts.end(), keyParts->begin(),
+		keyParts->end());
+
+	unsigned long long hash1 = ComputeFNV1aHash(&versionedKeyParts,
+		14695981039346656037ULL);
+	unsigned long long hash2 = ComputeFNV1aHash(&versionedKeyParts,
+		1099511628211ULL * 31ULL);
+
+	ostringstream key;
+	key << hex << setfill('0') << setw(16) << hash1 << setw(16) << hash2;
+	return key.str();
+}
+
+unsigned long long ComputeFNV1aHash(vector<string> *keyParts,
+	unsigned long long hash) {
+	const unsigned long long prime = 1099511628211ULL;
+
+	for (int i = 0; i < keyParts->size(); i++) {
+		string part = keyParts->at(i);
+		for (int j = 0; j < part.size(); j++) {
+			hash ^= (unsigned char)part[j];
+			hash *= prime;
+		}
+
+		/* Separate the parts so that ("ab", "c") and ("a", "bc") differ */
+		hash ^= 0xff;
+		hash *= prime;
+	}
+
+	return hash;
+}
+
+string GetAnalysisCacheEntryFileName(string cacheDir, string key) {
+	return cacheDir + "/" + key + ".isl";
+}
+
+bool ReadAnalysisCacheEntry(string cacheDir, string key,
+	vector<string> *records) {
+	ifstream inFile;
+	inFile.open(GetAnalysisCacheEntryFileName(cacheDir, key),
+		ios::in | ios::binary);
+
+	if (!inFile) {
+		return false;
+	}
+
+	if (!ReadAnalysisRecords(inFile, records)) {
+		cout << "Ignoring the corrupt analysis cache entry: " << key << endl;
+		return false;
+	}
+
+	inFile.close();
+	return true;
+}
+
+bool ReadAnalysisRecords(istream& file, vector<string> *records) {
+	/* The records are of the form:
+	<number of records>
+	<length of record 1>
+	<record 1>
+	...
+	*/
+	long numRecords = -1;
+	if (!(file >> numRecords) || numRecords < 0) {
+		return false;
+	}
+
+	for (long i = 0; i < numRecords; i++) {
+		long length = -1;
+		if (!(file >> length) || length < 0) {
+			records->clear();
+			return false;
+		}
+
+		/* Skip the new line following the length */
+		file.get();
+		string record(length, '\0');
+		if (length > 0 && !file.read(&record[0], length)) {
+			records->clear();
+			return false;
+		}
+
+		records->push_back(record);
+	}
+
+	return true;
+}
+
+void WriteAnalysisCacheEntry(string cacheDir, string key,
+	vector<string> *records) {
+	CreateAnalysisCacheDirectory(cacheDir);
+
+	/* The entry is written to a temporary file first, and then renamed, so
+	that concurrent polyscientist processes never read a partial entry. */
+	string fileName = GetAnalysisCacheEntryFileName(cacheDir, key);
+	ostringstream tempFileName;
+	tempFileName << fileName << ".tmp." << getpid() << "." << this_thread::get_id();
+
+	ofstream file;
+	file.open(tempFileName.str(), ios::out | ios::binary);
+	if (!file.is_open()) {
+		cout << "Could not write to the analysis cache: " << tempFileName.str()
+			<< endl;
+		return;
+	}
+
+	WriteAnalysisRecords(file, records);
+	file.close();
+
+	if (rename(tempFileName.str().c_str(), fileName.c_str()) != 0) {
+		cout << "Could not write to the analysis cache: " << fileName << endl;
+		remove(tempFileName.str().c_str());
+	}
+}
+
+void WriteAnalysisRecords(ostream& file, vector<string> *records) {
+	file << records->size() << endl;
+	for (int i = 0; i < records->size(); i++) {
+		file << records->at(i).size() << endl;
+		file << records->at(i) << endl;
+	}
+}
+
+void CreateAnalysisCacheDirectory(string cacheDir) {
+	if (mkdir(cacheDir.c_str(), 0755) != 0 && errno != EEXIST) {
+		cout << "Could not create the analysis cache directory: " << cacheDir
+			<< endl;
+	}
+}
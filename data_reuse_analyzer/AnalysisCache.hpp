@@ -0,0 +1,21 @@
+#ifndef ANALYSIS_CACHE_HPP
+#define ANALYSIS_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+/* A content-addressed, on-disk cache of analysis results. An entry is a list
+of strings (typically isl objects in their textual form) stored under a key
+computed from the strings the result depends on. */
+std::string ComputeAnalysisCacheKey(std::vector<std::string> *keyParts);
+bool ReadAnalysisCacheEntry(std::string cacheDir, std::string key,
+	std::vector<std::string> *records);
+void WriteAnalysisCacheEntry(std::string cacheDir, std::string key,
+	std::vector<std::string> *records);
+/* The list of strings of an entry, in the format in which it is stored. Other
+files that only polyscientist reads back, e.g., the scop snapshots, use it too. */
+bool ReadAnalysisRecords(std::istream& file, std::vector<std::string> *records);
+void WriteAnalysisRecords(std::ostream& file, std::vector<std::string> *records);
+
+#endif
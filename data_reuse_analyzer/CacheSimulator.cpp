@@ -0,0 +1,980 @@
+#include <CacheSimulator.hpp>
+#include <isl/ast.h>
+#include <isl/ast_build.h>
+#include <isl/aff.h>
+#include <isl/id.h>
+#include <isl/map.h>
+#include <isl/union_map.h>
+#include <isl/union_set.h>
+#include <isl/val.h>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+/* The associativities of the caches whose associativity is not given */
+#define DEFAULT_L1_ASSOC 8
+#define DEFAULT_L2_ASSOC 16
+#define DEFAULT_L3_ASSOC 16
+
+enum SimExprType { SIM_EXPR_INT, SIM_EXPR_SLOT, SIM_EXPR_OP };
+
+/* An expression of the AST whose iterators are bound to the slots of the
+simulator and whose parameters are replaced by their values */
+struct SimExpr {
+	SimExprType type;
+	long value;
+	int slot;
+	isl_ast_expr_op_type op;
+	vector<SimExpr*>* args;
+};
+
+typedef struct SimExpr SimExpr;
+
+/* An array laid out in row-major order. The index of every dimension is
+offset by its lower bound, and the strides are in bytes. */
+struct SimArray {
+	int id;
+	long base;
+	vector<long>* mins;
+	vector<long>* strides;
+};
+
+typedef struct SimArray SimArray;
+
+/* An access of a statement, whose byte address is base plus the dot product of
+strides and the iterators of the statement */
+struct SimAccess {
+	int array;
+	long base;
+	vector<long>* strides;
+};
+
+typedef struct SimAccess SimAccess;
+
+struct SimStatement {
+	vector<SimAccess*>* accesses;
+	vector<long>* iterators;
+};
+
+typedef struct SimStatement SimStatement;
+
+enum SimNodeType { SIM_NODE_FOR, SIM_NODE_IF, SIM_NODE_BLOCK, SIM_NODE_USER };
+
+struct SimNode {
+	SimNodeType type;
+	int slot; // the iterator of a for node
+	SimExpr* init;
+	SimExpr* cond; // also the condition of an if node
+	SimExpr* inc;
+	SimNode* body; // also the then node of an if node
+	SimNode* elseNode;
+	vector<SimNode*>* children;
+	SimStatement* statement;
+	vector<SimExpr*>* args;
+};
+
+typedef struct SimNode SimNode;
+
+/* A set-associative cache with LRU replacement. The tags and the last uses of
+the ways of a set are consecutive. */
+struct SimCache {
+	long numSets;
+	int assoc;
+	vector<long>* tags;
+	vector<unsigned long>* lastUses;
+	unsigned long clock;
+};
+
+typedef struct SimCache SimCache;
+
+struct CacheSimulator {
+	SimCache caches[3];
+	long lineSize;
+	vector<long>* slots;
+	/* The hits of L1, L2 and L3 and then their misses, for every array */
+	vector<long>* counters;
+	vector<long>* snapshot;
+	int sampling;
+	int loopDepth;
+};
+
+typedef struct CacheSimulator CacheSimulator;
+
+struct SimCompilation {
+	unordered_map<string, int>* paramValues;
+	unordered_map<string, int>* slots;
+	unordered_map<string, SimArray*>* arrays;
+	unordered_map<string, SimStatement*>* statements;
+	SimStatement* statement;
+	isl_set* context;
+	bool isCompiled;
+};
+
+typedef struct SimCompilation SimCompilation;
+
+struct AffPieces {
+	vector<isl_aff*>* affs;
+};
+
+typedef struct AffPieces AffPieces;
+
+bool LayOutSimArrays(Scop* scop, Config* config,
+	SimCompilation* compilation, vector<string>* arrayNames);
+bool EvaluateSetDimBound(isl_set* set, int pos, bool isMax,
+	unordered_map<string, int>* paramValues, long* value);
+isl_stat CollectAffPiece(isl_set* set, isl_aff* aff, void* user);
+isl_stat CollectMultiAffPiece(isl_set* set, isl_multi_aff* ma, void* user);
+bool LowerAff(isl_aff* aff, unordered_map<string, int>* paramValues,
+	vector<long>* coefficients, long* constant);
+bool CompileSimStatements(Scop* scop, SimCompilation* compilation);
+isl_stat AddSimAccess(isl_map* map, void* user);
+SimExpr* CompileSimExpr(isl_ast_expr* expr, SimCompilation* compilation);
+bool IsSimulatedOp(isl_ast_expr_op_type op);
+SimNode* CompileSimNode(isl_ast_node* node, SimCompilation* compilation);
+SimNode* CompileSimUserNode(isl_ast_node* node, SimNode* simNode,
+	SimCompilation* compilation);
+SimNode* NewSimNode(SimNodeType type);
+long EvaluateSimExpr(SimExpr* expr, CacheSimulator* sim);
+void ExecuteSimNode(SimNode* node, CacheSimulator* sim);
+void ExecuteSampledSimLoop(SimNode* node, CacheSimulator* sim);
+void ExecuteSimStatement(SimNode* node, CacheSimulator* sim);
+void SimulateAccess(CacheSimulator* sim, int array, long address);
+bool AccessSimCache(SimCache* cache, long line);
+void InitializeSimCache(SimCache* cache, long size, int assoc, long numSets,
+	long lineSize);
+void FreeSimExpr(SimExpr* expr);
+void FreeSimNode(SimNode* node);
+
+bool SimulateCaches(Scop* scop, isl_set* context,
+	unordered_map<string, int>* paramValues, Config* config, int sampling,
+	vector<SimulatedArrayStats>* arrayStats) {
+	/* The statement instances are executed in the order of the schedule of the
+	SCoP, by interpreting the AST generated from it with the parameters fixed
+	by the context. The AST is first compiled so that an access costs its
+	address arithmetic and a lookup of the sets of the caches. The reads of a
+	statement instance are simulated before its writes. An access looks up L1,
+	L2 and L3 in this order until it hits, and its line is brought into every
+	cache that it missed. The arrays are laid out one after another at page
+	boundaries. False is returned if the SCoP cannot be simulated, e.g., for a
+	non-affine access. */
+	SimCompilation* compilation = new SimCompilation;
+	compilation->paramValues = paramValues;
+	compilation->slots = new unordered_map<string, int>();
+	compilation->arrays = new unordered_map<string, SimArray*>();
+	compilation->statements = new unordered_map<string, SimStatement*>();
+	compilation->statement = NULL;
+	compilation->context = context;
+	compilation->isCompiled = true;
+
+	vector<string> arrayNames;
+	SimNode* root = NULL;
+	if (LayOutSimArrays(scop, config, compilation, &arrayNames) &&
+		CompileSimStatements(scop, compilation)) {
+		isl_ast_build* build = isl_ast_build_from_context(
+			isl_set_params(isl_set_copy(context)));
+		isl_ast_node* tree = isl_ast_build_node_from_schedule(build,
+			isl_schedule_copy(scop->schedule));
+		isl_ast_build_free(build);
+		root = CompileSimNode(tree, compilation);
+	}
+
+	bool isSimulated = compilation->isCompiled && root != NULL;
+	if (isSimulated) {
+		SystemConfig* systemConfig = config->systemConfig;
+		CacheSimulator* sim = new CacheSimulator;
+		sim->lineSize = systemConfig->lineSize;
+		InitializeSimCache(&sim->caches[0], systemConfig->L1,
+			systemConfig->L1Assoc > 0 ? systemConfig->L1Assoc : DEFAULT_L1_ASSOC,
+			systemConfig->L1Sets, sim->lineSize);
+		InitializeSimCache(&sim->caches[1], systemConfig->L2,
+			systemConfig->L2Assoc > 0 ? systemConfig->L2Assoc : DEFAULT_L2_ASSOC,
+			systemConfig->L2Sets, sim->lineSize);
+		InitializeSimCache(&sim->caches[2], systemConfig->L3,
+			systemConfig->L3Assoc > 0 ? systemConfig->L3Assoc : DEFAULT_L3_ASSOC,
+			systemConfig->L3Sets, sim->lineSize);
+		sim->slots = new vector<long>(compilation->slots->size(), 0);
+		sim->counters = new vector<long>(6 * arrayNames.size(), 0);
+		sim->snapshot = new vector<long>(6 * arrayNames.size(), 0);
+		sim->sampling = sampling;
+		sim->loopDepth = 0;
+
+		ExecuteSimNode(root, sim);
+
+		arrayStats->clear();
+		for (int i = 0; i < arrayNames.size(); i++) {
+			SimulatedArrayStats stats;
+			stats.array = arrayNames[i];
+			for (int level = 0; level < 3; level++) {
+				stats.hits[level] = sim->counters->at(6 * i + level);
+				stats.misses[level] = sim->counters->at(6 * i + 3 + level);
+			}
+
+			arrayStats->push_back(stats);
+		}
+
+		for (int level = 0; level < 3; level++) {
+			delete sim->caches[level].tags;
+			delete sim->caches[level].lastUses;
+		}
+
+		delete sim->slots;
+		delete sim->counters;
+		delete sim->snapshot;
+		delete sim;
+	}
+
+	FreeSimNode(root);
+	for (auto i : *compilation->statements) {
+		for (int j = 0; j < i.second->accesses->size(); j++) {
+			delete i.second->accesses->at(j)->strides;
+			delete i.second->accesses->at(j);
+		}
+
+		delete i.second->accesses;
+		delete i.second->iterators;
+		delete i.second;
+	}
+
+	for (auto i : *compilation->arrays) {
+		delete i.second->mins;
+		delete i.second->strides;
+		delete i.second;
+	}
+
+	delete compilation->slots;
+	delete compilation->arrays;
+	delete compilation->statements;
+	delete compilation;
+	return isSimulated;
+}
+
+bool LayOutSimArrays(Scop* scop, Config* config,
+	SimCompilation* compilation, vector<string>* arrayNames) {
+	long next = config->systemConfig->pageSize;
+	for (int i = 0; i < scop->arrayExtents->size(); i++) {
+		isl_set* extent = scop->arrayExtents->at(i);
+		const char* name = isl_set_get_tuple_name(extent);
+		if (name == NULL ||
+			compilation->arrays->find(name) != compilation->arrays->end()) {
+			continue;
+		}
+
+		isl_set* fixedExtent = isl_set_intersect_params(isl_set_copy(extent),
+			isl_set_copy(compilation->context));
+		isl_size numDims = isl_set_dim(fixedExtent, isl_dim_set);
+		vector<long> mins(numDims);
+		vector<long> maxs(numDims);
+		bool isBounded = true;
+		for (int j = 0; j < numDims && isBounded; j++) {
+			isBounded = EvaluateSetDimBound(fixedExtent, j, false,
+				compilation->paramValues, &mins[j]) &&
+				EvaluateSetDimBound(fixedExtent, j, true,
+					compilation->paramValues, &maxs[j]);
+		}
+
+		isl_set_free(fixedExtent);
+		if (!isBounded) {
+			cout << "The extent of the array " << name
+				<< " is not bounded and it cannot be simulated" << endl;
+			return false;
+		}
+
+		SimArray* array = new SimArray;
+		array->id = arrayNames->size();
+		array->mins = new vector<long>(mins);
+		array->strides = new vector<long>(numDims);
+		long size = GetArrayDatatypeSize(config, name);
+		for (int j = numDims - 1; j >= 0; j--) {
+			array->strides->at(j) = size;
+			size = size * (maxs[j] - mins[j] + 1);
+		}
+
+		array->base = next;
+		long pageSize = config->systemConfig->pageSize;
+		next = next + (size + pageSize - 1) / pageSize * pageSize;
+
+		compilation->arrays->insert({ name, array });
+		arrayNames->push_back(name);
+	}
+
+	return true;
+}
+
+bool EvaluateSetDimBound(isl_set* set, int pos, bool isMax,
+	unordered_map<string, int>* paramValues, long* value) {
+	/* The bound is a piecewise affine expression over the parameters. The
+	pieces whose domains do not hold for the parameter values are empty. */
+	isl_pw_aff* bound = isMax ? isl_set_dim_max(isl_set_copy(set), pos) :
+		isl_set_dim_min(isl_set_copy(set), pos);
+	AffPieces pieces;
+	pieces.affs = new vector<isl_aff*>();
+	isl_pw_aff_foreach_piece(bound, &CollectAffPiece, &pieces);
+	isl_pw_aff_free(bound);
+
+	bool isEvaluated = !pieces.affs->empty();
+	for (int i = 0; i < pieces.affs->size(); i++) {
+		isl_aff* aff = pieces.affs->at(i);
+		vector<long> coefficients;
+		long constant;
+		if (isEvaluated && isl_aff_is_nan(aff) != isl_bool_true &&
+			LowerAff(aff, paramValues, &coefficients, &constant)) {
+			*value = i == 0 ? constant :
+				(isMax ? max(*value, constant) : min(*value, constant));
+		}
+		else {
+			isEvaluated = false;
+		}
+
+		isl_aff_free(aff);
+	}
+
+	delete pieces.affs;
+	return isEvaluated;
+}
+
+isl_stat CollectAffPiece(isl_set* set, isl_aff* aff, void* user) {
+	AffPieces* pieces = (AffPieces*)user;
+	isl_set_free(set);
+	pieces->affs->push_back(aff);
+	return isl_stat_ok;
+}
+
+isl_stat CollectMultiAffPiece(isl_set* set, isl_multi_aff* ma, void* user) {
+	vector<isl_multi_aff*>* pieces = (vector<isl_multi_aff*>*)user;
+	isl_set_free(set);
+	pieces->push_back(ma);
+	return isl_stat_ok;
+}
+
+bool LowerAff(isl_aff* aff, unordered_map<string, int>* paramValues,
+	vector<long>* coefficients, long* constant) {
+	/* An affine expression of integer coefficients and without integer
+	divisions is lowered to the coefficients of its input dimensions and a
+	constant that includes its parameters times their values */
+	isl_val* denominator = isl_aff_get_denominator_val(aff);
+	bool isIntegral = isl_val_is_one(denominator) == isl_bool_true;
+	isl_val_free(denominator);
+	if (!isIntegral || isl_aff_dim(aff, isl_dim_div) > 0) {
+		return false;
+	}
+
+	isl_val* val = isl_aff_get_constant_val(aff);
+	*constant = isl_val_get_num_si(val);
+	isl_val_free(val);
+
+	isl_size numParams = isl_aff_dim(aff, isl_dim_param);
+	for (int i = 0; i < numParams; i++) {
+		val = isl_aff_get_coefficient_val(aff, isl_dim_param, i);
+		long coefficient = isl_val_get_num_si(val);
+		isl_val_free(val);
+		if (coefficient == 0) {
+			continue;
+		}
+
+		const char* name = isl_aff_get_dim_name(aff, isl_dim_param, i);
+		if (name == NULL ||
+			paramValues->find(name) == paramValues->end()) {
+			return false;
+		}
+
+		*constant += coefficient * paramValues->at(name);
+	}
+
+	coefficients->clear();
+	isl_size numDims = isl_aff_dim(aff, isl_dim_in);
+	for (int i = 0; i < numDims; i++) {
+		val = isl_aff_get_coefficient_val(aff, isl_dim_in, i);
+		coefficients->push_back(isl_val_get_num_si(val));
+		isl_val_free(val);
+	}
+
+	return true;
+}
+
+bool CompileSimStatements(Scop* scop, SimCompilation* compilation) {
+	/* A statement whose domain is not named, e.g., one with arguments of
+	its own, is only an error if the AST executes it */
+	isl_union_map* reads = isl_union_map_copy(scop->mayReads);
+	isl_union_map* writes = isl_union_map_copy(scop->mayWrites);
+
+	for (int i = 0; i < scop->statements->size() && compilation->isCompiled;
+		i++) {
+		isl_set* domain = scop->statements->at(i).domain;
+		const char* name = isl_set_get_tuple_name(domain);
+		if (name == NULL) {
+			continue;
+		}
+
+		SimStatement* statement = new SimStatement;
+		statement->accesses = new vector<SimAccess*>();
+		statement->iterators = new vector<long>(
+			isl_set_dim(domain, isl_dim_set), 0);
+		compilation->statements->insert({ name, statement });
+		compilation->statement = statement;
+
+		isl_union_map* statementReads = isl_union_map_intersect_domain(
+			isl_union_map_copy(reads),
+			isl_union_set_from_set(isl_set_copy(domain)));
+		isl_union_map_foreach_map(statementReads, &AddSimAccess, compilation);
+		isl_union_map_free(statementReads);
+
+		isl_union_map* statementWrites = isl_union_map_intersect_domain(
+			isl_union_map_copy(writes),
+			isl_union_set_from_set(isl_set_copy(domain)));
+		isl_union_map_foreach_map(statementWrites, &AddSimAccess, compilation);
+		isl_union_map_free(statementWrites);
+	}
+
+	isl_union_map_free(reads);
+	isl_union_map_free(writes);
+	return compilation->isCompiled;
+}
+
+isl_stat AddSimAccess(isl_map* map, void* user) {
+	SimCompilation* compilation = (SimCompilation*)user;
+	map = isl_map_intersect_params(map, isl_set_copy(compilation->context));
+	if (isl_map_is_empty(map) == isl_bool_true) {
+		isl_map_free(map);
+		return isl_stat_ok;
+	}
+
+	const char* tupleName = isl_map_get_tuple_name(map, isl_dim_out);
+	string name = tupleName ? tupleName : "an unnamed array";
+	auto array = compilation->arrays->find(name);
+	if (array == compilation->arrays->end() ||
+		isl_map_is_single_valued(map) != isl_bool_true) {
+		cout << "The access to " << name
+			<< " is not single valued and it cannot be simulated" << endl;
+		isl_map_free(map);
+		compilation->isCompiled = false;
+		return isl_stat_error;
+	}
+
+	isl_pw_multi_aff* pma = isl_pw_multi_aff_from_map(map);
+	vector<isl_multi_aff*> pieces;
+	isl_pw_multi_aff_foreach_piece(pma, &CollectMultiAffPiece, &pieces);
+	isl_pw_multi_aff_free(pma);
+
+	SimArray* simArray = array->second;
+	SimAccess* access = new SimAccess;
+	access->array = simArray->id;
+	access->base = simArray->base;
+	access->strides = new vector<long>(
+		compilation->statement->iterators->size(), 0);
+	bool isAffine = pieces.size() == 1;
+	if (isAffine) {
+		isl_size numDims = isl_multi_aff_dim(pieces[0], isl_dim_out);
+		for (int i = 0; i < numDims && isAffine; i++) {
+			isl_aff* aff = isl_multi_aff_get_aff(pieces[0], i);
+			vector<long> coefficients;
+			long constant;
+			isAffine = LowerAff(aff, compilation->paramValues, &coefficients,
+				&constant);
+			isl_aff_free(aff);
+			if (!isAffine) {
+				break;
+			}
+
+			long stride = simArray->strides->at(i);
+			access->base += stride * (constant - simArray->mins->at(i));
+			for (int j = 0; j < coefficients.size(); j++) {
+				access->strides->at(j) += stride * coefficients[j];
+			}
+		}
+	}
+
+	for (int i = 0; i < pieces.size(); i++) {
+		isl_multi_aff_free(pieces[i]);
+	}
+
+	if (!isAffine) {
+		cout << "The access to " << name
+			<< " is not affine and it cannot be simulated" << endl;
+		delete access->strides;
+		delete access;
+		compilation->isCompiled = false;
+		return isl_stat_error;
+	}
+
+	compilation->statement->accesses->push_back(access);
+	return isl_stat_ok;
+}
+
+SimExpr* CompileSimExpr(isl_ast_expr* expr, SimCompilation* compilation) {
+	/* An expression that cannot be compiled is compiled to 0 and the
+	compilation fails */
+	SimExpr* simExpr = new SimExpr;
+	simExpr->type = SIM_EXPR_INT;
+	simExpr->value = 0;
+	simExpr->slot = -1;
+	simExpr->op = isl_ast_expr_op_error;
+	simExpr->args = NULL;
+
+	switch (isl_ast_expr_get_type(expr)) {
+	case isl_ast_expr_int: {
+		isl_val* val = isl_ast_expr_int_get_val(expr);
+		simExpr->value = isl_val_get_num_si(val);
+		isl_val_free(val);
+		break;
+	}
+	case isl_ast_expr_id: {
+		isl_id* id = isl_ast_expr_id_get_id(expr);
+		string name = isl_id_get_name(id);
+		isl_id_free(id);
+		if (compilation->slots->find(name) != compilation->slots->end()) {
+			simExpr->type = SIM_EXPR_SLOT;
+			simExpr->slot = compilation->slots->at(name);
+		}
+		else if (compilation->paramValues->find(name) !=
+			compilation->paramValues->end()) {
+			simExpr->value = compilation->paramValues->at(name);
+		}
+		else {
+			cout << "The value of " << name << " is not known" << endl;
+			compilation->isCompiled = false;
+		}
+
+		break;
+	}
+	case isl_ast_expr_op: {
+		simExpr->op = isl_ast_expr_op_get_type(expr);
+		if (!IsSimulatedOp(simExpr->op)) {
+			compilation->isCompiled = false;
+			break;
+		}
+
+		simExpr->type = SIM_EXPR_OP;
+		simExpr->args = new vector<SimExpr*>();
+		isl_size numArgs = isl_ast_expr_op_get_n_arg(expr);
+		for (int i = 0; i < numArgs; i++) {
+			simExpr->args->push_back(CompileSimExpr(
+				isl_ast_expr_op_get_arg(expr, i), compilation));
+		}
+
+		break;
+	}
+	default:
+		compilation->isCompiled = false;
+		break;
+	}
+
+	isl_ast_expr_free(expr);
+	return simExpr;
+}
+
+bool IsSimulatedOp(isl_ast_expr_op_type op) {
+	switch (op) {
+	case isl_ast_expr_op_and:
+	case isl_ast_expr_op_and_then:
+	case isl_ast_expr_op_or:
+	case isl_ast_expr_op_or_else:
+	case isl_ast_expr_op_max:
+	case isl_ast_expr_op_min:
+	case isl_ast_expr_op_minus:
+	case isl_ast_expr_op_add:
+	case isl_ast_expr_op_sub:
+	case isl_ast_expr_op_mul:
+	case isl_ast_expr_op_div:
+	case isl_ast_expr_op_fdiv_q:
+	case isl_ast_expr_op_pdiv_q:
+	case isl_ast_expr_op_pdiv_r:
+	case isl_ast_expr_op_zdiv_r:
+	case isl_ast_expr_op_cond:
+	case isl_ast_expr_op_select:
+	case isl_ast_expr_op_eq:
+	case isl_ast_expr_op_le:
+	case isl_ast_expr_op_lt:
+	case isl_ast_expr_op_ge:
+	case isl_ast_expr_op_gt:
+		return true;
+	default:
+		return false;
+	}
+}
+
+SimNode* NewSimNode(SimNodeType type) {
+	SimNode* simNode = new SimNode;
+	simNode->type = type;
+	simNode->slot = -1;
+	simNode->init = NULL;
+	simNode->cond = NULL;
+	simNode->inc = NULL;
+	simNode->body = NULL;
+	simNode->elseNode = NULL;
+	simNode->children = NULL;
+	simNode->statement = NULL;
+	simNode->args = NULL;
+	return simNode;
+}
+
+SimNode* CompileSimNode(isl_ast_node* node, SimCompilation* compilation) {
+	if (node == NULL) {
+		compilation->isCompiled = false;
+		return NULL;
+	}
+
+	SimNode* simNode = NULL;
+	switch (isl_ast_node_get_type(node)) {
+	case isl_ast_node_for: {
+		/* The iterator is bound to a slot before the condition, the
+		increment and the body refer to it */
+		simNode = NewSimNode(SIM_NODE_FOR);
+		isl_ast_expr* iterator = isl_ast_node_for_get_iterator(node);
+		isl_id* id = isl_ast_expr_id_get_id(iterator);
+		string name = isl_id_get_name(id);
+		isl_id_free(id);
+		isl_ast_expr_free(iterator);
+
+		if (compilation->slots->find(name) == compilation->slots->end()) {
+			int slot = compilation->slots->size();
+			compilation->slots->insert({ name, slot });
+		}
+
+		simNode->slot = compilation->slots->at(name);
+		simNode->init = CompileSimExpr(isl_ast_node_for_get_init(node),
+			compilation);
+		simNode->cond = CompileSimExpr(isl_ast_node_for_get_cond(node),
+			compilation);
+		simNode->inc = CompileSimExpr(isl_ast_node_for_get_inc(node),
+			compilation);
+		simNode->body = CompileSimNode(isl_ast_node_for_get_body(node),
+			compilation);
+		break;
+	}
+	case isl_ast_node_if:
+		simNode = NewSimNode(SIM_NODE_IF);
+		simNode->cond = CompileSimExpr(isl_ast_node_if_get_cond(node),
+			compilation);
+		simNode->body = CompileSimNode(isl_ast_node_if_get_then_node(node),
+			compilation);
+		if (isl_ast_node_if_has_else_node(node) == isl_bool_true) {
+			simNode->elseNode = CompileSimNode(
+				isl_ast_node_if_get_else_node(node), compilation);
+		}
+
+		break;
+	case isl_ast_node_block: {
+		simNode = NewSimNode(SIM_NODE_BLOCK);
+		simNode->children = new vector<SimNode*>();
+		isl_ast_node_list* children = isl_ast_node_block_get_children(node);
+		isl_size numChildren = isl_ast_node_list_n_ast_node(children);
+		for (int i = 0; i < numChildren; i++) {
+			simNode->children->push_back(CompileSimNode(
+				isl_ast_node_list_get_ast_node(children, i), compilation));
+		}
+
+		isl_ast_node_list_free(children);
+		break;
+	}
+	case isl_ast_node_mark:
+		simNode = CompileSimNode(isl_ast_node_mark_get_node(node), compilation);
+		break;
+	case isl_ast_node_user:
+		simNode = CompileSimUserNode(node, NewSimNode(SIM_NODE_USER),
+			compilation);
+		break;
+	default:
+		compilation->isCompiled = false;
+		break;
+	}
+
+	isl_ast_node_free(node);
+	return simNode;
+}
+
+SimNode* CompileSimUserNode(isl_ast_node* node, SimNode* simNode,
+	SimCompilation* compilation) {
+	/* A user node calls a statement with the values of its iterators */
+	simNode->args = new vector<SimExpr*>();
+	isl_ast_expr* call = isl_ast_node_user_get_expr(node);
+	isl_ast_expr* callee = isl_ast_expr_op_get_arg(call, 0);
+	isl_id* id = isl_ast_expr_id_get_id(callee);
+	string name = isl_id_get_name(id);
+	isl_id_free(id);
+	isl_ast_expr_free(callee);
+
+	auto statement = compilation->statements->find(name);
+	isl_size numArgs = isl_ast_expr_op_get_n_arg(call);
+	if (statement == compilation->statements->end() ||
+		statement->second->iterators->size() != numArgs - 1) {
+		cout << "The statement " << name << " cannot be simulated" << endl;
+		compilation->isCompiled = false;
+	}
+	else {
+		simNode->statement = statement->second;
+		for (int i = 1; i < numArgs; i++) {
+			simNode->args->push_back(CompileSimExpr(
+				isl_ast_expr_op_get_arg(call, i), compilation));
+		}
+	}
+
+	isl_ast_expr_free(call);
+	return simNode;
+}
+
+long EvaluateSimExpr(SimExpr* expr, CacheSimulator* sim) {
+	if (expr->type == SIM_EXPR_INT) {
+		return expr->value;
+	}
+
+	if (expr->type == SIM_EXPR_SLOT) {
+		return (*sim->slots)[expr->slot];
+	}
+
+	vector<SimExpr*>& args = *expr->args;
+	switch (expr->op) {
+	case isl_ast_expr_op_and:
+	case isl_ast_expr_op_and_then:
+		return EvaluateSimExpr(args[0], sim) && EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_or:
+	case isl_ast_expr_op_or_else:
+		return EvaluateSimExpr(args[0], sim) || EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_max: {
+		long value = EvaluateSimExpr(args[0], sim);
+		for (int i = 1; i < args.size(); i++) {
+			value = max(value, EvaluateSimExpr(args[i], sim));
+		}
+
+		return value;
+	}
+	case isl_ast_expr_op_min: {
+		long value = EvaluateSimExpr(args[0], sim);
+		for (int i = 1; i < args.size(); i++) {
+			value = min(value, EvaluateSimExpr(args[i], sim));
+		}
+
+		return value;
+	}
+	case isl_ast_expr_op_minus:
+		return -EvaluateSimExpr(args[0], sim);
+	case isl_ast_expr_op_add:
+		return EvaluateSimExpr(args[0], sim) + EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_sub:
+		return EvaluateSimExpr(args[0], sim) - EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_mul:
+		return EvaluateSimExpr(args[0], sim) * EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_div:
+	case isl_ast_expr_op_pdiv_q:
+		return EvaluateSimExpr(args[0], sim) / EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_fdiv_q: {
+		long numerator = EvaluateSimExpr(args[0], sim);
+		long denominator = EvaluateSimExpr(args[1], sim);
+		long quotient = numerator / denominator;
+		if (numerator % denominator != 0 &&
+			(numerator < 0) != (denominator < 0)) {
+			quotient--;
+		}
+
+		return quotient;
+	}
+	case isl_ast_expr_op_pdiv_r:
+	case isl_ast_expr_op_zdiv_r:
+		return EvaluateSimExpr(args[0], sim) % EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_cond:
+	case isl_ast_expr_op_select:
+		return EvaluateSimExpr(args[0], sim) ? EvaluateSimExpr(args[1], sim) :
+			EvaluateSimExpr(args[2], sim);
+	case isl_ast_expr_op_eq:
+		return EvaluateSimExpr(args[0], sim) == EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_le:
+		return EvaluateSimExpr(args[0], sim) <= EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_lt:
+		return EvaluateSimExpr(args[0], sim) < EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_ge:
+		return EvaluateSimExpr(args[0], sim) >= EvaluateSimExpr(args[1], sim);
+	case isl_ast_expr_op_gt:
+		return EvaluateSimExpr(args[0], sim) > EvaluateSimExpr(args[1], sim);
+	default:
+		return 0;
+	}
+}
+
+void ExecuteSimNode(SimNode* node, CacheSimulator* sim) {
+	switch (node->type) {
+	case SIM_NODE_FOR: {
+		if (sim->loopDepth == 0 && sim->sampling > 1) {
+			ExecuteSampledSimLoop(node, sim);
+			break;
+		}
+
+		long& iterator = (*sim->slots)[node->slot];
+		sim->loopDepth++;
+		for (iterator = EvaluateSimExpr(node->init, sim);
+			EvaluateSimExpr(node->cond, sim);
+			iterator += EvaluateSimExpr(node->inc, sim)) {
+			ExecuteSimNode(node->body, sim);
+		}
+
+		sim->loopDepth--;
+		break;
+	}
+	case SIM_NODE_IF:
+		if (EvaluateSimExpr(node->cond, sim)) {
+			ExecuteSimNode(node->body, sim);
+		}
+		else if (node->elseNode) {
+			ExecuteSimNode(node->elseNode, sim);
+		}
+
+		break;
+	case SIM_NODE_BLOCK:
+		for (int i = 0; i < node->children->size(); i++) {
+			ExecuteSimNode(node->children->at(i), sim);
+		}
+
+		break;
+	case SIM_NODE_USER:
+		ExecuteSimStatement(node, sim);
+		break;
+	}
+}
+
+void ExecuteSampledSimLoop(SimNode* node, CacheSimulator* sim) {
+	/* Only every sampling-th iteration of an outermost loop is executed, and
+	the hits and the misses of the loop are scaled by its number of iterations
+	over the number of iterations executed. The iterations of an outermost
+	parallel loop are alike and each of them starts from caches that hold the
+	data of the previous one executed. */
+	copy(sim->counters->begin(), sim->counters->end(), sim->snapshot->begin());
+	long numIterations = 0;
+	long numExecuted = 0;
+	long& iterator = (*sim->slots)[node->slot];
+	sim->loopDepth++;
+	for (iterator = EvaluateSimExpr(node->init, sim);
+		EvaluateSimExpr(node->cond, sim);
+		iterator += EvaluateSimExpr(node->inc, sim)) {
+		if (numIterations % sim->sampling == 0) {
+			ExecuteSimNode(node->body, sim);
+			numExecuted++;
+		}
+
+		numIterations++;
+	}
+
+	sim->loopDepth--;
+	if (numExecuted == 0) {
+		return;
+	}
+
+	double scale = (double)numIterations / numExecuted;
+	for (int i = 0; i < sim->counters->size(); i++) {
+		long before = sim->snapshot->at(i);
+		sim->counters->at(i) = before +
+			llround((sim->counters->at(i) - before) * scale);
+	}
+}
+
+void ExecuteSimStatement(SimNode* node, CacheSimulator* sim) {
+	SimStatement* statement = node->statement;
+	vector<long>& iterators = *statement->iterators;
+	for (int i = 0; i < node->args->size(); i++) {
+		iterators[i] = EvaluateSimExpr(node->args->at(i), sim);
+	}
+
+	for (int i = 0; i < statement->accesses->size(); i++) {
+		SimAccess* access = statement->accesses->at(i);
+		vector<long>& strides = *access->strides;
+		long address = access->base;
+		for (int j = 0; j < strides.size(); j++) {
+			address += strides[j] * iterators[j];
+		}
+
+		SimulateAccess(sim, access->array, address);
+	}
+}
+
+void SimulateAccess(CacheSimulator* sim, int array, long address) {
+	long line = address / sim->lineSize;
+	long* counters = sim->counters->data() + 6 * array;
+	for (int level = 0; level < 3; level++) {
+		if (AccessSimCache(&sim->caches[level], line)) {
+			counters[level]++;
+			return;
+		}
+
+		counters[3 + level]++;
+	}
+}
+
+bool AccessSimCache(SimCache* cache, long line) {
+	/* A miss replaces the least recently used line of the set, or an invalid
+	way, whose last use is 0 */
+	long set = line % cache->numSets;
+	long* tags = cache->tags->data() + set * cache->assoc;
+	unsigned long* lastUses = cache->lastUses->data() + set * cache->assoc;
+	cache->clock++;
+
+	int victim = 0;
+	for (int way = 0; way < cache->assoc; way++) {
+		if (tags[way] == line) {
+			lastUses[way] = cache->clock;
+			return true;
+		}
+
+		if (lastUses[way] < lastUses[victim]) {
+			victim = way;
+		}
+	}
+
+	tags[victim] = line;
+	lastUses[victim] = cache->clock;
+	return false;
+}
+
+void InitializeSimCache(SimCache* cache, long size, int assoc, long numSets,
+	long lineSize) {
+	/* The number of sets is derived from the size of the cache unless its
+	associativity is given, in which case it is that of the config */
+	cache->assoc = assoc;
+	cache->numSets = numSets > 0 ? numSets :
+		max(1L, size / (assoc * lineSize));
+	cache->tags = new vector<long>(cache->numSets * assoc, -1);
+	cache->lastUses = new vector<unsigned long>(cache->numSets * assoc, 0);
+	cache->clock = 0;
+}
+
+void FreeSimExpr(SimExpr* expr) {
+	if (expr == NULL) {
+		return;
+	}
+
+	if (expr->args) {
+		for (int i = 0; i < expr->args->size(); i++) {
+			FreeSimExpr(expr->args->at(i));
+		}
+
+		delete expr->args;
+	}
+
+	delete expr;
+}
+
+void FreeSimNode(SimNode* node) {
+	if (node == NULL) {
+		return;
+	}
+
+	FreeSimExpr(node->init);
+	FreeSimExpr(node->cond);
+	FreeSimExpr(node->inc);
+	FreeSimNode(node->body);
+	FreeSimNode(node->elseNode);
+	if (node->children) {
+		for (int i = 0; i < node->children->size(); i++) {
+			FreeSimNode(node->children->at(i));
+		}
+
+		delete node->children;
+	}
+
+	if (node->args) {
+		for (int i = 0; i < node->args->size(); i++) {
+			FreeSimExpr(node->args->at(i));
+		}
+
+		delete node->args;
+	}
+
+	delete node;
+}
@@ -0,0 +1,26 @@
+#ifndef CACHE_SIMULATOR_HPP
+#define CACHE_SIMULATOR_HPP
+
+#include <Scop.hpp>
+#include <isl/set.h>
+#include <ConfigProcessor.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/* The hits and the misses of the accesses to one array in the L1, L2 and L3
+caches, as simulated for one row of parameter values. An access that misses
+in L3 is served by the memory. */
+struct SimulatedArrayStats {
+	std::string array;
+	long hits[3];
+	long misses[3];
+};
+
+typedef struct SimulatedArrayStats SimulatedArrayStats;
+
+bool SimulateCaches(Scop* scop, isl_set* context,
+	std::unordered_map<std::string, int>* paramValues, Config* config,
+	int sampling, std::vector<SimulatedArrayStats>* arrayStats);
+
+#endif
@@ -2,38 +2,187 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 using namespace std;
 
 
 void ReadCacheConfig(ifstream& inFile, Config* config);
 void CheckIfConfigIsFullySpecified(Config* config);
 void InitializeConfig(Config* config);
+void ReadConfigOptions(UserInput *userInput, Config* config);
 void ReadDataTypeConfig(ifstream& inFile, Config* config);
 void ReadParams(ifstream& inFile, Config* config);
 void PrintConfig(Config* config);
 void ReadConfigFromFile(string configFile, Config* config);
 void ReadConfigFromUserInput(UserInput *userInput, Config* config);
 void ReadCacheConfig(string cachesizes, Config* config);
+void ReadMachineConfig(ifstream& inFile, Config* config);
+void ReadMachineConfig(string machine, Config* config);
+void CheckMachineConfig(Config* config);
 void ReadDataTypeConfig(string line, Config* config);
 void ReadParameterValues(string line, vector<string> *paramNames, Config* config);
 void ReadParams(string line, Config* config);
 void ReadParallelLoops(string parallelLoops, Config* config);
 void ReadSharedCacheConfig(string sharedcaches, Config* config);
+void CheckParallelLoopThreads(UserInput *userInput, Config* config);
+void ComputeCacheSets(SystemConfig* systemConfig);
+void DetectCacheConfig(Config* config);
+bool ReadSysfsValue(string fileName, string* value);
+long ParseSysfsCacheSize(string size);
+int CountCpusInList(string cpuList);
+long ComputeCacheSets(long size, int assoc, long lineSize);
+bool IsValidDataTypeConfig(string line);
+bool AreParallelLoopsValid(string parallelLoops, long numProcs);
+bool AreCacheSetsValid(SystemConfig* systemConfig);
 
 void ReadConfig(UserInput *userInput, Config* config) {
 
 	string configFile = userInput->configFile;
 
 	/* Initialization */
-	InitializeConfig(config);
-	config->datatypeSize = -1;
+	ReadConfigOptions(userInput, config);
 
 	if (!userInput->configFile.empty()) {
 		ReadConfigFromFile(userInput->configFile, config);
+
+		/* The caches detected replace those of the config file, so that the
+		same config file serves all the machines */
+		if (userInput->detectCaches) {
+			DetectCacheConfig(config);
+		}
+
+		CheckIfConfigIsFullySpecified(config);
+		ReadParallelLoops(userInput->parallelLoops, config);
+		ReadSharedCacheConfig(userInput->sharedcaches, config);
 	}
 	else {
 		ReadConfigFromUserInput(userInput, config);
 	}
+
+	/* The machine given by --machine overrides that of the config file */
+	ReadMachineConfig(userInput->machine, config);
+	CheckMachineConfig(config);
+	CheckParallelLoopThreads(userInput, config);
+	ComputeCacheSets(config->systemConfig);
+}
+
+void ReadConfig(UserInput *userInput, SystemConfig *systemConfig,
+	Config* config) {
+	/* The machine is given, and the parameter values are left to the caller.
+	Only the options that do not describe the machine are read. */
+	ReadConfigOptions(userInput, config);
+	*config->systemConfig = *systemConfig;
+	ReadDataTypeConfig(userInput->datatypesize, config);
+	ReadParallelLoops(userInput->parallelLoops, config);
+	CheckMachineConfig(config);
+	CheckParallelLoopThreads(userInput, config);
+	ComputeCacheSets(config->systemConfig);
+}
+
+bool AreConfigOptionsValid(UserInput *userInput, SystemConfig *systemConfig) {
+	/* The options on which ReadConfig() of a given machine quits, checked
+	without printing or quitting, so that a caller of the library may reject
+	them instead */
+	if (!IsValidDataTypeConfig(userInput->datatypesize)) {
+		return false;
+	}
+
+	if (userInput->roofline && systemConfig->peakGflops == 0) {
+		return false;
+	}
+
+	return AreParallelLoopsValid(userInput->parallelLoops, userInput->numProcs)
+		&& AreCacheSetsValid(systemConfig);
+}
+
+bool IsValidDataTypeConfig(string line) {
+	/* As read by ReadDataTypeConfig() */
+	istringstream iss(line);
+	string size;
+
+	while (iss >> size) {
+		try {
+			int pos = size.find(":");
+			if (pos == string::npos) {
+				stol(size, nullptr, 10);
+			}
+			else if (stoi(size.substr(pos + 1), nullptr, 10) <= 0) {
+				return false;
+			}
+		}
+		catch (const invalid_argument) {
+			return false;
+		}
+		catch (const out_of_range) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool AreParallelLoopsValid(string parallelLoops, long numProcs) {
+	/* As read by ReadParallelLoops() and checked by CheckParallelLoopThreads() */
+	istringstream iss(parallelLoops);
+	string loopName;
+	int numLoops = 0;
+	int numSpecified = 0;
+	long product = 1;
+	while (iss >> loopName) {
+		numLoops++;
+		size_t colon = loopName.find(':');
+		if (colon == string::npos) {
+			continue;
+		}
+
+		int numThreads = -1;
+		try {
+			numThreads = stoi(loopName.substr(colon + 1), nullptr, 10);
+		}
+		catch (const invalid_argument) {
+		}
+		catch (const out_of_range) {
+		}
+
+		if (numThreads <= 0) {
+			return false;
+		}
+
+		numSpecified++;
+		product *= numThreads;
+	}
+
+	return numSpecified == 0 ||
+		(numSpecified == numLoops && product == numProcs);
+}
+
+bool AreCacheSetsValid(SystemConfig* systemConfig) {
+	/* As computed by ComputeCacheSets() */
+	long sizes[3] = { systemConfig->L1, systemConfig->L2, systemConfig->L3 };
+	int assocs[3] = { systemConfig->L1Assoc, systemConfig->L2Assoc,
+		systemConfig->L3Assoc };
+	for (int level = 0; level < 3; level++) {
+		if (assocs[level] > 0 && (systemConfig->lineSize <= 0 ||
+			sizes[level] / (assocs[level] * systemConfig->lineSize) <= 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ReadConfigOptions(UserInput *userInput, Config* config) {
+	InitializeConfig(config);
+	config->datatypeSize = -1;
+	config->countCacheLines = userInput->cacheLines;
+	config->modelTLB = userInput->tlb;
+	config->reportArrays = userInput->arrayStats;
+	config->predictPerformance = userInput->roofline;
+	config->reportReuseDistances = userInput->reuseHistogram;
+	/* The roofline model takes the bytes moved between the levels */
+	config->modelTraffic = userInput->traffic || userInput->roofline;
+	config->dependenceTimeout = userInput->dependenceTimeout;
+	config->dependenceMaxOperations = userInput->dependenceMaxOperations;
 }
 
 void ReadConfigFromUserInput(UserInput *userInput, Config* config) {
@@ -42,7 +191,7 @@ void ReadConfigFromUserInput(UserInput *userInput, Config* config) {
 		exit(1);
 	}
 
-	if (userInput->cachesizes.empty()) {
+	if (userInput->cachesizes.empty() && !userInput->detectCaches) {
 		cout << "Cache sizes not provided." << endl;
 		exit(1);
 	}
@@ -52,6 +201,11 @@ void ReadConfigFromUserInput(UserInput *userInput, Config* config) {
 		exit(1);
 	}
 
+	/* The caches given by --cachesizes override those detected */
+	if (userInput->detectCaches) {
+		DetectCacheConfig(config);
+	}
+
 	ReadCacheConfig(userInput->cachesizes, config);
 	ReadDataTypeConfig(userInput->datatypesize, config);
 	ReadParams(userInput->parameters, config);
@@ -63,6 +217,7 @@ void ReadConfigFromFile(string configFile, Config* config) {
 	const string CACHE_HEADER = "cache";
 	const string DATATYPE_SIZE_HEADER = "datatype_size";
 	const string PARAMS_HEADER = "params";
+	const string MACHINE_HEADER = "machine";
 
 	ifstream inFile;
 	inFile.open(configFile);
@@ -84,9 +239,11 @@ void ReadConfigFromFile(string configFile, Config* config) {
 		else if (line == PARAMS_HEADER) {
 			ReadParams(inFile, config);
 		}
+		else if (line == MACHINE_HEADER) {
+			ReadMachineConfig(inFile, config);
+		}
 	}
 
-	CheckIfConfigIsFullySpecified(config);
 	inFile.close();
 }
 
@@ -106,6 +263,68 @@ void ReadCacheConfig(string cachesizes, Config* config) {
 			else if (cache == "L3") {
 				config->systemConfig->L3 = stol(size, nullptr, 10);
 			}
+			else if (cache == "line") {
+				config->systemConfig->lineSize = stol(size, nullptr, 10);
+				if (config->systemConfig->lineSize <= 0) {
+					cout << "Invalid cache line size: " << size << endl;
+					exit(1);
+				}
+			}
+			else if (cache == "page" || cache == "DTLB" || cache == "STLB") {
+				long value = stol(size, nullptr, 10);
+				if (value <= 0) {
+					cout << "Invalid " << cache << " size: " << size << endl;
+					exit(1);
+				}
+
+				if (cache == "page") {
+					config->systemConfig->pageSize = value;
+				}
+				else if (cache == "DTLB") {
+					config->systemConfig->DTLBEntries = value;
+				}
+				else {
+					config->systemConfig->STLBEntries = value;
+				}
+			}
+			else if (cache == "sockets" || cache == "cores_per_socket") {
+				int value = stoi(size, nullptr, 10);
+				if (value <= 0) {
+					cout << "Invalid number of " << cache << ": " << size << endl;
+					exit(1);
+				}
+
+				if (cache == "sockets") {
+					config->systemConfig->numSockets = value;
+				}
+				else {
+					config->systemConfig->coresPerSocket = value;
+				}
+			}
+			else if (cache == "remote_cost") {
+				config->systemConfig->remoteMemoryCost = stod(size, nullptr);
+				if (config->systemConfig->remoteMemoryCost < 1) {
+					cout << "Invalid remote memory cost: " << size << endl;
+					exit(1);
+				}
+			}
+			else if (cache == "L1_assoc" || cache == "L2_assoc" || cache == "L3_assoc") {
+				int assoc = stoi(size, nullptr, 10);
+				if (assoc <= 0) {
+					cout << "Invalid cache associativity: " << size << endl;
+					exit(1);
+				}
+
+				if (cache == "L1_assoc") {
+					config->systemConfig->L1Assoc = assoc;
+				}
+				else if (cache == "L2_assoc") {
+					config->systemConfig->L2Assoc = assoc;
+				}
+				else {
+					config->systemConfig->L3Assoc = assoc;
+				}
+			}
 			else {
 				cout << "Cache in config file not known: " << cache << endl;
 				exit(1);
@@ -118,49 +337,293 @@ void ReadCacheConfig(string cachesizes, Config* config) {
 	}
 }
 
+void ReadMachineConfig(string machine, Config* config) {
+	istringstream iss(machine);
+	string key;
+	string value;
+
+	while ((iss >> key >> value)) {
+		double number;
+		try {
+			number = stod(value, nullptr);
+		}
+		catch (const invalid_argument) {
+			cerr << "Invalid machine description while reading the config file" << endl;
+			exit(1);
+		}
+
+		if (number <= 0) {
+			cout << "Invalid " << key << ": " << value << endl;
+			exit(1);
+		}
+
+		if (key == "peak") {
+			config->systemConfig->peakGflops = number;
+		}
+		else if (key == "L2_bw") {
+			config->systemConfig->L2Bandwidth = number;
+		}
+		else if (key == "L3_bw") {
+			config->systemConfig->L3Bandwidth = number;
+		}
+		else if (key == "Mem_bw") {
+			config->systemConfig->MemBandwidth = number;
+		}
+		else {
+			cout << "Machine description in config file not known: " << key << endl;
+			exit(1);
+		}
+	}
+}
+
+void CheckMachineConfig(Config* config) {
+	if (config->predictPerformance && config->systemConfig->peakGflops == 0) {
+		cout << "The peak flops of the machine not provided." << endl;
+		exit(1);
+	}
+}
+
+void DetectCacheConfig(Config* config) {
+	/* Reads the data and unified caches of cpu0 from sysfs. A cache whose
+	shared_cpu_list has more than one cpu is shared: an L1 or an L2 cache by
+	the hardware threads of a core, and an L3 cache by all the threads. */
+	const string cacheDir = "/sys/devices/system/cpu/cpu0/cache/index";
+	SystemConfig* systemConfig = config->systemConfig;
+	int numCachesDetected = 0;
+
+	for (int i = 0; ; i++) {
+		string indexDir = cacheDir + to_string(i) + "/";
+		string level, type, size;
+		if (!ReadSysfsValue(indexDir + "level", &level)) {
+			break;
+		}
+
+		if (!ReadSysfsValue(indexDir + "type", &type) || type == "Instruction" ||
+			!ReadSysfsValue(indexDir + "size", &size)) {
+			continue;
+		}
+
+		long cacheSize = ParseSysfsCacheSize(size);
+		if (cacheSize <= 0) {
+			continue;
+		}
+
+		string lineSize, assoc, sharedCpuList;
+		int numSharers = 1;
+		if (ReadSysfsValue(indexDir + "shared_cpu_list", &sharedCpuList)) {
+			numSharers = CountCpusInList(sharedCpuList);
+		}
+
+		if (ReadSysfsValue(indexDir + "coherency_line_size", &lineSize) &&
+			atol(lineSize.c_str()) > 0) {
+			systemConfig->lineSize = atol(lineSize.c_str());
+		}
+
+		int ways = 0;
+		if (ReadSysfsValue(indexDir + "ways_of_associativity", &assoc)) {
+			ways = atoi(assoc.c_str());
+		}
+
+		if (level == "1") {
+			systemConfig->L1 = cacheSize;
+			systemConfig->L1Assoc = max(ways, 0);
+			systemConfig->L1Shared = numSharers > 1;
+			systemConfig->L1SharingDegree = max(numSharers, 1);
+		}
+		else if (level == "2") {
+			systemConfig->L2 = cacheSize;
+			systemConfig->L2Assoc = max(ways, 0);
+			systemConfig->L2Shared = numSharers > 1;
+			systemConfig->L2SharingDegree = max(numSharers, 1);
+		}
+		else if (level == "3") {
+			systemConfig->L3 = cacheSize;
+			systemConfig->L3Assoc = max(ways, 0);
+			systemConfig->L3Shared = numSharers > 1;
+		}
+		else {
+			continue;
+		}
+
+		numCachesDetected++;
+		cout << "Detected L" << level << " " << type << " cache: " << cacheSize
+			<< " bytes, " << ways << "-way, shared by " << numSharers
+			<< " cpus" << endl;
+	}
+
+	if (numCachesDetected == 0) {
+		cout << "Could not detect the caches from " << cacheDir << "*" << endl;
+		exit(1);
+	}
+}
+
+bool ReadSysfsValue(string fileName, string* value) {
+	ifstream inFile;
+	inFile.open(fileName);
+	if (!inFile || !getline(inFile, *value)) {
+		return false;
+	}
+
+	return true;
+}
+
+long ParseSysfsCacheSize(string size) {
+	/* The size is of the form 32K, 1024K or 36M */
+	long value = atol(size.c_str());
+	if (size.find('K') != string::npos) {
+		value *= 1024;
+	}
+	else if (size.find('M') != string::npos) {
+		value *= 1024 * 1024;
+	}
+
+	return value;
+}
+
+int CountCpusInList(string cpuList) {
+	/* The list is of the form 0-1,28-29 */
+	int numCpus = 0;
+	istringstream iss(cpuList);
+	string range;
+	while (getline(iss, range, ',')) {
+		size_t pos = range.find('-');
+		if (pos == string::npos) {
+			numCpus += 1;
+		}
+		else {
+			numCpus += atoi(range.substr(pos + 1).c_str())
+				- atoi(range.substr(0, pos).c_str()) + 1;
+		}
+	}
+
+	return numCpus;
+}
+
 void ReadSharedCacheConfig(string sharedcaches, Config* config) {
+	/* The shared caches are separated by spaces or commas, e.g., "L1:2,L2:2 L3".
+	The L1 and L2 caches are shared by the hardware threads of a core and their
+	number follows the cache. The L3 cache is shared by all the threads. */
+	replace(sharedcaches.begin(), sharedcaches.end(), ',', ' ');
 	istringstream iss(sharedcaches);
 	string cache;
 
 	while ((iss >> cache)) {
-		try {
-			if (cache == "L1") {
-				config->systemConfig->L1Shared = true;
+		int sharingDegree = 0;
+		size_t colon = cache.find(':');
+		if (colon != string::npos) {
+			try {
+				sharingDegree = stoi(cache.substr(colon + 1), nullptr, 10);
 			}
-			else if (cache == "L2") {
-				config->systemConfig->L2Shared = true;
+			catch (const invalid_argument) {
+				sharingDegree = -1;
 			}
-			else if (cache == "L3") {
-				config->systemConfig->L3Shared = true;
+
+			if (sharingDegree <= 0) {
+				cout << "Invalid number of threads sharing the cache: " << cache << endl;
+				exit(1);
+			}
+
+			cache = cache.substr(0, colon);
+		}
+
+		if (cache == "L1" || cache == "L2") {
+			if (sharingDegree == 0) {
+				cout << "The number of hardware threads sharing the " << cache
+					<< " cache is not given, e.g., " << cache << ":2" << endl;
+				exit(1);
+			}
+
+			if (cache == "L1") {
+				config->systemConfig->L1Shared = sharingDegree > 1;
+				config->systemConfig->L1SharingDegree = sharingDegree;
 			}
 			else {
-				cout << "Cache in config file not known: " << cache << endl;
+				config->systemConfig->L2Shared = sharingDegree > 1;
+				config->systemConfig->L2SharingDegree = sharingDegree;
+			}
+		}
+		else if (cache == "L3") {
+			if (sharingDegree != 0) {
+				cout << "The L3 cache is shared by all the threads. "
+					<< "Its number of threads cannot be given: " << sharedcaches << endl;
 				exit(1);
 			}
+
+			config->systemConfig->L3Shared = true;
 		}
-		catch (const invalid_argument) {
-			cerr << "Invalid cache size while reading the config file" << endl;
+		else {
+			cout << "Cache in config file not known: " << cache << endl;
 			exit(1);
 		}
 	}
 }
 
 void ReadParallelLoops(string parallelLoops, Config* config) {
+	/* The parallel loops are listed from the outermost to the innermost, e.g.,
+	"img ofm_tile". A loop may be followed by the number of threads it is split
+	across, e.g., "img:4 ofm_tile:7". */
 	config->parallelLoops = NULL;
+	config->parallelLoopThreads = NULL;
 	if (!parallelLoops.empty()) {
 		config->parallelLoops = new vector<string>();
+		config->parallelLoopThreads = new vector<int>();
 		istringstream iss(parallelLoops);
 		string loopName;
 		while (iss >> loopName) {
+			int numThreads = 0;
+			size_t colon = loopName.find(':');
+			if (colon != string::npos) {
+				try {
+					numThreads = stoi(loopName.substr(colon + 1), nullptr, 10);
+				}
+				catch (const invalid_argument) {
+					numThreads = -1;
+				}
+
+				if (numThreads <= 0) {
+					cout << "Invalid number of threads for the parallel loop: "
+						<< loopName << endl;
+					exit(1);
+				}
+
+				loopName = loopName.substr(0, colon);
+			}
+
 			config->parallelLoops->push_back(loopName);
+			config->parallelLoopThreads->push_back(numThreads);
 		}
+	}
+}
 
-		if (config->parallelLoops->size() > 1) {
-			cout << "Multiple parallel loops have been declared."
-				<< "Make the outermost loop, the parallel loop for equivalent analysis." << endl;
-			exit(1);
+void CheckParallelLoopThreads(UserInput *userInput, Config* config) {
+	/* Either all the parallel loops are given their numbers of threads, whose
+	product must then be the number of processors, or none of them is */
+	if (config->parallelLoops == NULL) {
+		return;
+	}
+
+	int numSpecified = 0;
+	long product = 1;
+	for (int i = 0; i < config->parallelLoopThreads->size(); i++) {
+		if (config->parallelLoopThreads->at(i) > 0) {
+			numSpecified++;
+			product *= config->parallelLoopThreads->at(i);
 		}
 	}
+
+	if (numSpecified != 0 &&
+		numSpecified != config->parallelLoopThreads->size()) {
+		cout << "The number of threads is specified for some of the parallel loops "
+			<< "but not for all of them. Quitting." << endl;
+		exit(1);
+	}
+
+	if (numSpecified != 0 && product != userInput->numProcs) {
+		cout << "The product of the numbers of threads of the parallel loops ("
+			<< product << ") is not the number of processors ("
+			<< userInput->numProcs << "). Quitting." << endl;
+		exit(1);
+	}
 }
 
 void ReadCacheConfig(ifstream& inFile, Config* config) {
@@ -174,6 +637,17 @@ void ReadCacheConfig(ifstream& inFile, Config* config) {
 	}
 }
 
+void ReadMachineConfig(ifstream& inFile, Config* config) {
+	string line;
+	while (getline(inFile, line)) {
+		if (line == "\n" || line.empty()) {
+			break;
+		}
+
+		ReadMachineConfig(line, config);
+	}
+}
+
 void ReadParameterNames(string line, vector<string> *paramNames) {
 	if (line == "\n" || line.empty()) {
 	}
@@ -262,14 +736,48 @@ void ReadParams(ifstream& inFile, Config* config) {
 }
 
 void ReadDataTypeConfig(string line, Config* config) {
-	try {
-		config->datatypeSize = stol(line, nullptr, 10);
+	/* The data type size of all the arrays may be followed by those of the
+	arrays of other data types, e.g., "4 pad_gemm_input:2 filter:1" */
+	istringstream iss(line);
+	string size;
+
+	while (iss >> size) {
+		try {
+			int pos = size.find(":");
+			if (pos == string::npos) {
+				config->datatypeSize = stol(size, nullptr, 10);
+				continue;
+			}
+
+			int arrayDatatypeSize = stoi(size.substr(pos + 1), nullptr, 10);
+			if (arrayDatatypeSize <= 0) {
+				cout << "Invalid datatype size of the array: " << size << endl;
+				exit(1);
+			}
+
+			if (config->arrayDatatypeSizes == NULL) {
+				config->arrayDatatypeSizes = new unordered_map<string, int>();
+			}
+
+			(*config->arrayDatatypeSizes)[size.substr(0, pos)] = arrayDatatypeSize;
+		}
+		catch (const invalid_argument) {
+			cerr << "Datatype size line: " << line << endl;
+			cerr << "Invalid datatype size while reading the config file" << endl;
+			exit(1);
+		}
 	}
-	catch (const invalid_argument) {
-		cerr << "Datatype size line: " << line << endl;
-		cerr << "Invalid datatype size while reading the config file" << endl;
-		exit(1);
+}
+
+int GetArrayDatatypeSize(Config* config, string array) {
+	if (config->arrayDatatypeSizes) {
+		auto found = config->arrayDatatypeSizes->find(array);
+		if (found != config->arrayDatatypeSizes->end()) {
+			return found->second;
+		}
 	}
+
+	return config->datatypeSize;
 }
 
 
@@ -288,12 +796,68 @@ void InitializeConfig(Config* config) {
 	config->systemConfig = new SystemConfig;
 	config->programParameterVector = new vector<unordered_map<string, int>*>();
 	config->datatypeSize = 0;
+	config->arrayDatatypeSizes = NULL;
+	config->parallelLoops = NULL;
+	config->parallelLoopThreads = NULL;
 	config->systemConfig->L1 = 0;
 	config->systemConfig->L2 = 0;
 	config->systemConfig->L3 = 0;
 	config->systemConfig->L1Shared = false;
 	config->systemConfig->L2Shared = false;
 	config->systemConfig->L3Shared = false;
+	config->systemConfig->L1SharingDegree = 1;
+	config->systemConfig->L2SharingDegree = 1;
+	config->systemConfig->lineSize = 64;
+	config->systemConfig->L1Assoc = 0;
+	config->systemConfig->L2Assoc = 0;
+	config->systemConfig->L3Assoc = 0;
+	config->systemConfig->L1Sets = 0;
+	config->systemConfig->L2Sets = 0;
+	config->systemConfig->L3Sets = 0;
+	config->systemConfig->pageSize = 4096;
+	config->systemConfig->DTLBEntries = 64;
+	config->systemConfig->STLBEntries = 1536;
+	config->systemConfig->numSockets = 1;
+	config->systemConfig->coresPerSocket = 0;
+	config->systemConfig->remoteMemoryCost = 1;
+	config->systemConfig->peakGflops = 0;
+	config->systemConfig->L2Bandwidth = 0;
+	config->systemConfig->L3Bandwidth = 0;
+	config->systemConfig->MemBandwidth = 0;
+	config->countCacheLines = false;
+	config->modelTLB = false;
+	config->reportArrays = false;
+	config->modelTraffic = false;
+	config->predictPerformance = false;
+	config->reportReuseDistances = false;
+	config->dependenceTimeout = 0;
+	config->dependenceMaxOperations = 0;
+}
+
+void ComputeCacheSets(SystemConfig* systemConfig) {
+	systemConfig->L1Sets = ComputeCacheSets(systemConfig->L1,
+		systemConfig->L1Assoc, systemConfig->lineSize);
+	systemConfig->L2Sets = ComputeCacheSets(systemConfig->L2,
+		systemConfig->L2Assoc, systemConfig->lineSize);
+	systemConfig->L3Sets = ComputeCacheSets(systemConfig->L3,
+		systemConfig->L3Assoc, systemConfig->lineSize);
+}
+
+long ComputeCacheSets(long size, int assoc, long lineSize) {
+	if (assoc <= 0) {
+		return 0;
+	}
+
+	/* A cache whose size is not a multiple of a way, e.g., a sliced L3 cache,
+	is modeled by its whole sets */
+	long numSets = size / (assoc * lineSize);
+	if (numSets <= 0) {
+		cout << "The associativity " << assoc << " is too large for the cache of "
+			<< size << " bytes" << endl;
+		exit(1);
+	}
+
+	return numSets;
 }
 
 void CheckIfConfigIsFullySpecified(Config* config) {
@@ -312,7 +876,7 @@ void CheckIfConfigIsFullySpecified(Config* config) {
 		exit(1);
 	}
 
-	if (config->datatypeSize == 0) {
+	if (config->datatypeSize <= 0) {
 		cout << "Data type size not found in config file" << endl;
 		exit(1);
 	}
@@ -320,9 +884,51 @@ void CheckIfConfigIsFullySpecified(Config* config) {
 
 void PrintConfig(Config* config) {
 	cout << "Datatype size: " << config->datatypeSize << endl;
+	if (config->arrayDatatypeSizes) {
+		for (auto it = config->arrayDatatypeSizes->begin();
+			it != config->arrayDatatypeSizes->end(); it++) {
+			cout << "Datatype size of " << it->first << ": " << it->second << endl;
+		}
+	}
+
 	cout << "L1 cache size: " << config->systemConfig->L1 << endl;
 	cout << "L2 cache size: " << config->systemConfig->L2 << endl;
 	cout << "L3 cache size: " << config->systemConfig->L3 << endl;
+	cout << "Cache line size: " << config->systemConfig->lineSize << endl;
+	if (config->systemConfig->L1Assoc > 0) {
+		cout << "L1 cache: " << config->systemConfig->L1Assoc << "-way, "
+			<< config->systemConfig->L1Sets << " sets" << endl;
+	}
+
+	if (config->systemConfig->L2Assoc > 0) {
+		cout << "L2 cache: " << config->systemConfig->L2Assoc << "-way, "
+			<< config->systemConfig->L2Sets << " sets" << endl;
+	}
+
+	if (config->systemConfig->L3Assoc > 0) {
+		cout << "L3 cache: " << config->systemConfig->L3Assoc << "-way, "
+			<< config->systemConfig->L3Sets << " sets" << endl;
+	}
+
+	if (config->modelTLB) {
+		cout << "Page size: " << config->systemConfig->pageSize << endl;
+		cout << "DTLB entries: " << config->systemConfig->DTLBEntries << endl;
+		cout << "STLB entries: " << config->systemConfig->STLBEntries << endl;
+	}
+
+	if (config->systemConfig->numSockets > 1) {
+		cout << "Sockets: " << config->systemConfig->numSockets
+			<< ", cores per socket: " << config->systemConfig->coresPerSocket
+			<< ", remote memory cost: " << config->systemConfig->remoteMemoryCost
+			<< endl;
+	}
+
+	if (config->systemConfig->peakGflops > 0) {
+		cout << "Peak GFLOPS: " << config->systemConfig->peakGflops << endl;
+		cout << "Bandwidths (GB/s): L2 " << config->systemConfig->L2Bandwidth
+			<< ", L3 " << config->systemConfig->L3Bandwidth
+			<< ", Mem " << config->systemConfig->MemBandwidth << endl;
+	}
 
 	cout << "Program parameters:" << endl;
 	for (int i = 0; i < config->programParameterVector->size(); i++) {
@@ -337,7 +943,12 @@ void PrintConfig(Config* config) {
 	cout << "Parallel loops" << endl;
 	if (config->parallelLoops) {
 		for (int i = 0; i < config->parallelLoops->size(); i++) {
-			cout << config->parallelLoops->at(i) << " ";
+			cout << config->parallelLoops->at(i);
+			if (config->parallelLoopThreads->at(i) > 0) {
+				cout << ":" << config->parallelLoopThreads->at(i);
+			}
+
+			cout << " ";
 		}
 
 		cout << endl;
@@ -356,8 +967,10 @@ void FreeConfig(Config* config) {
 	if (config->parallelLoops) {
 		config->parallelLoops->clear();
 		delete config->parallelLoops;
+		delete config->parallelLoopThreads;
 	}
 
+	delete config->arrayDatatypeSizes;
 	delete config->programParameterVector;
 	delete config;
 }
\ No newline at end of file
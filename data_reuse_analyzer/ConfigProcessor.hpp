@@ -13,6 +13,35 @@ struct SystemConfig {
 	bool L1Shared;
 	bool L2Shared;
 	bool L3Shared;
+	int L1SharingDegree; // #hardware threads sharing an L1 cache
+	int L2SharingDegree; // #hardware threads sharing an L2 cache
+	long lineSize; // in bytes
+	/* The associativity of each cache. A zero means that it is not known and
+	that the conflicts in the cache are not modeled. */
+	int L1Assoc;
+	int L2Assoc;
+	int L3Assoc;
+	/* The number of sets of each cache, derived from its size, associativity
+	and line size. Zero when the associativity is not known. */
+	long L1Sets;
+	long L2Sets;
+	long L3Sets;
+	long pageSize; // in bytes
+	long DTLBEntries; // #entries of the first level data TLB
+	long STLBEntries; // #entries of the second level TLB
+	/* The sockets of the machine, each with an L3 cache of size L3 and its own
+	memory, and the cores of a socket. Zero cores when not known. */
+	int numSockets;
+	int coresPerSocket;
+	/* The cost of an access to the memory of another socket relative to that
+	of an access to the local memory */
+	double remoteMemoryCost;
+	/* The peak flops of the threads, in GFLOPS, and the bandwidths of the bytes
+	moved out of L2, L3 and the memory, in GB/s. Zero when not known. */
+	double peakGflops;
+	double L2Bandwidth;
+	double L3Bandwidth;
+	double MemBandwidth;
 };
 
 typedef struct SystemConfig SystemConfig;
@@ -21,12 +50,40 @@ struct Config {
 	SystemConfig *systemConfig;
 	std::vector<std::unordered_map<std::string, int>*> *programParameterVector;
 	int datatypeSize;
+	/* The data type sizes of the arrays whose data type size differs from
+	datatypeSize, by their names. NULL when all the arrays are of datatypeSize. */
+	std::unordered_map<std::string, int> *arrayDatatypeSizes;
+	/* Whether the data sets are counted in cache lines instead of elements */
+	bool countCacheLines;
+	/* Whether the pages of the working sets are placed in the TLBs */
+	bool modelTLB;
+	/* Whether the data of the working sets are split by array */
+	bool reportArrays;
+	/* Whether the memory traffic of the accesses is modeled */
+	bool modelTraffic;
+	/* Whether the performance is predicted by a roofline model */
+	bool predictPerformance;
+	/* Whether the reuse distances are reported as histograms */
+	bool reportReuseDistances;
+	/* The wall time, in seconds, and the number of isl operations the analysis
+	of a dependence may take before its data sets are bounded instead of being
+	counted. Zero for no limit. */
+	double dependenceTimeout;
+	unsigned long dependenceMaxOperations;
 	std::vector<std::string> *parallelLoops;
+	/* The number of threads each parallel loop is split across, in the order
+	of parallelLoops. A zero means that the split is derived from the trip
+	counts of the loops, as for a collapsed parallel loop nest. */
+	std::vector<int> *parallelLoopThreads;
 };
 
 typedef struct Config Config;
 
 void ReadConfig(UserInput *userInput, Config* config);
+void ReadConfig(UserInput *userInput, SystemConfig *systemConfig,
+	Config* config);
+bool AreConfigOptionsValid(UserInput *userInput, SystemConfig *systemConfig);
 void FreeConfig(Config* config);
 void PrintConfig(Config* config);
+int GetArrayDatatypeSize(Config* config, std::string array);
 #endif
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include <PolyScientist.hpp>
+
+int main(int argc, char **argv) {
+	OrchestrateDataReuseComputation(argc, argv);
+	return 0;
+}
@@ -0,0 +1,597 @@
+#include <EvaluatorEmitter.hpp>
+#include <Utility.hpp>
+#include <isl/ast_build.h>
+#include <isl/aff.h>
+#include <isl/set.h>
+#include <isl/val.h>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+using namespace std;
+
+struct PolynomialLowering {
+	vector<string>* pieces;
+	bool isLowered;
+};
+
+typedef struct PolynomialLowering PolynomialLowering;
+
+struct TermLowering {
+	vector<string>* paramNames;
+	vector<string>* monomials;
+	vector<long>* numerators;
+	vector<long>* denominators;
+	bool isLowered;
+};
+
+typedef struct TermLowering TermLowering;
+
+void CollectParameterNames(isl_union_pw_qpolynomial* polynomial,
+	vector<string>* names);
+string LowerUnionPwQpolynomialToC(isl_union_pw_qpolynomial* polynomial);
+isl_stat LowerPwQpolynomialToC(isl_pw_qpolynomial *pwqp, void *user);
+isl_stat LowerPieceToC(isl_set *set, isl_qpolynomial *qp, void *user);
+string LowerQpolynomialToC(isl_qpolynomial* qp);
+isl_stat LowerTermToC(isl_term *term, void *user);
+string LowerPwAffToC(isl_pw_aff* pwaff);
+string LowerSetToC(isl_set* set);
+void EmitParameterDeclarations(ofstream& file, vector<string>* names);
+
+void EmitEvaluator(string fileName, string inputFile,
+	vector<EvaluatorWorkingSet*>* workingSets,
+	isl_union_pw_qpolynomial* totalDataSetSize,
+	EvaluatorParallelLoops* parallelLoops, SystemConfig* systemConfig,
+	int datatypeSize, bool ignoreSizeOne) {
+	/* Emits a self-contained C file that computes the pessimistic L1, L2, L3
+	and memory data set sizes for a vector of parameter values, the same way
+	SimplifyWorkingSetSizes() does for one row of the config file. Each
+	piecewise quasi-polynomial is lowered to a sum of conditional expressions
+	over its pieces. The conditions and the integer divisions are generated
+	with the isl AST generator. A polynomial that cannot be lowered evaluates
+	to -1, i.e., to no working set. */
+	ofstream file;
+	file.open(fileName);
+
+	if (file.is_open()) {
+		cout << "Writing the evaluator to file " << fileName << endl;
+	}
+	else {
+		cout << "Could not open the file: " << fileName << endl;
+		exit(1);
+	}
+
+	vector<string> names;
+	CollectParameterNames(totalDataSetSize, &names);
+	for (int i = 0; i < workingSets->size(); i++) {
+		if (workingSets->at(i)->parallelLoop == false) {
+			CollectParameterNames(workingSets->at(i)->minSize, &names);
+			CollectParameterNames(workingSets->at(i)->maxSize, &names);
+		}
+		else {
+			CollectParameterNames(workingSets->at(i)->dataSetUnionSize, &names);
+			CollectParameterNames(workingSets->at(i)->dataSetCommonSize, &names);
+			CollectParameterNames(workingSets->at(i)->numParallelIters, &names);
+		}
+	}
+
+	int numParallelLoops = 0;
+	if (parallelLoops->threads) {
+		numParallelLoops = parallelLoops->threads->size();
+	}
+
+	if (parallelLoops->tripCounts) {
+		for (int i = 0; i < parallelLoops->tripCounts->size(); i++) {
+			if (parallelLoops->tripCounts->at(i)) {
+				CollectParameterNames(parallelLoops->tripCounts->at(i), &names);
+			}
+		}
+	}
+
+	sort(names.begin(), names.end());
+	names.erase(unique(names.begin(), names.end()), names.end());
+
+	int numWorkingSets = workingSets->size();
+	int arraySize = max(numWorkingSets, 1);
+
+	file << "/* Generated by polyscientist from " << inputFile << ".\n"
+		<< "The parameters are passed in the order of\n"
+		<< "polyscientist_parameter_names. The cache sizes and the size of the\n"
+		<< "data type can be overridden at compile time. */\n\n";
+
+	file << "#define floord(n, d) (((n) < 0) ? -((-(n) + (d) - 1) / (d)) : (n) / (d))\n"
+		<< "#define min(x, y) ((x) < (y) ? (x) : (y))\n"
+		<< "#define max(x, y) ((x) > (y) ? (x) : (y))\n\n";
+
+	file << "#ifndef POLYSCIENTIST_L1\n#define POLYSCIENTIST_L1 "
+		<< systemConfig->L1 << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_L2\n#define POLYSCIENTIST_L2 "
+		<< systemConfig->L2 << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_L3\n#define POLYSCIENTIST_L3 "
+		<< systemConfig->L3 << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_L1_SHARING_DEGREE\n#define POLYSCIENTIST_L1_SHARING_DEGREE "
+		<< systemConfig->L1SharingDegree << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_L2_SHARING_DEGREE\n#define POLYSCIENTIST_L2_SHARING_DEGREE "
+		<< systemConfig->L2SharingDegree << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_SOCKETS\n#define POLYSCIENTIST_SOCKETS "
+		<< systemConfig->numSockets << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_CORES_PER_SOCKET\n#define POLYSCIENTIST_CORES_PER_SOCKET "
+		<< systemConfig->coresPerSocket << "L\n#endif\n"
+		<< "#ifndef POLYSCIENTIST_DATATYPE_SIZE\n#define POLYSCIENTIST_DATATYPE_SIZE "
+		<< datatypeSize << "L\n#endif\n\n";
+
+	file << "#define POLYSCIENTIST_NUM_PARAMETERS " << names.size() << "\n"
+		<< "#define POLYSCIENTIST_NUM_WORKING_SETS " << numWorkingSets << "\n\n";
+
+	file << "const char *polyscientist_parameter_names[] = {";
+	for (int i = 0; i < names.size(); i++) {
+		file << (i == 0 ? " " : ", ") << "\"" << names[i] << "\"";
+	}
+	file << " };\n\n";
+
+	file << "struct polyscientist_data_set_sizes {\n"
+		<< "\tlong L1;\n\tlong L2;\n\tlong L3;\n\tlong Mem;\n};\n\n";
+
+	file << "long polyscientist_total_data_set_size(const long *params)\n{\n";
+	EmitParameterDeclarations(file, &names);
+	file << "\treturn " << LowerUnionPwQpolynomialToC(totalDataSetSize)
+		<< ";\n}\n\n";
+
+	/* Mirrors ComputeParallelLoopThreads() */
+	file << "#ifndef POLYSCIENTIST_NUM_PROCS\n#define POLYSCIENTIST_NUM_PROCS "
+		<< parallelLoops->numProcs << "L\n#endif\n\n";
+	file << "static long polyscientist_parallel_loop_threads(const long *params,\n"
+		<< "\tlong *threads)\n{\n";
+	EmitParameterDeclarations(file, &names);
+	file << "\tlong numThreadsLeft = POLYSCIENTIST_NUM_PROCS;\n"
+		<< "\tlong tripCount;\n\n"
+		<< "\t(void)numThreadsLeft;\n\t(void)tripCount;\n";
+	for (int i = 0; i < numParallelLoops; i++) {
+		if (parallelLoops->threads->at(i) > 0) {
+			file << "\tthreads[" << i << "] = " << parallelLoops->threads->at(i)
+				<< ";\n";
+			continue;
+		}
+
+		file << "\ttripCount = ";
+		if (parallelLoops->tripCounts && parallelLoops->tripCounts->at(i)) {
+			file << LowerUnionPwQpolynomialToC(parallelLoops->tripCounts->at(i));
+		}
+		else {
+			file << "-1L";
+		}
+
+		file << ";\n"
+			<< "\tthreads[" << i << "] = tripCount > 0 ? min(numThreadsLeft, tripCount)"
+			<< " : numThreadsLeft;\n"
+			<< "\tnumThreadsLeft = (numThreadsLeft + threads[" << i << "] - 1) / threads["
+			<< i << "];\n";
+	}
+
+	if (numParallelLoops == 0) {
+		file << "\treturn POLYSCIENTIST_NUM_PROCS;\n}\n\n";
+	}
+	else {
+		file << "\treturn min(";
+		for (int i = 0; i < numParallelLoops; i++) {
+			file << (i == 0 ? "" : " * ") << "threads[" << i << "]";
+		}
+		file << ", POLYSCIENTIST_NUM_PROCS);\n}\n\n";
+	}
+
+	/* Returns the number of threads that have work. dataSetSizes[0] and
+	dataSetSizes[1] are set to the largest sizes of the union and of the common
+	part of the data sets of two iterations of a parallel loop. */
+	file << "static long polyscientist_working_set_sizes(const long *params,\n"
+		<< "\tlong *minSizes, long *maxSizes, int *isParallel, long *dataSetSizes)\n{\n"
+		<< "\tlong threads[" << max(numParallelLoops, 1) << "];\n"
+		<< "\tlong numActiveThreads;\n\n";
+	EmitParameterDeclarations(file, &names);
+	file << "\tnumActiveThreads = polyscientist_parallel_loop_threads(params, threads);\n"
+		<< "\t(void)threads;\n"
+		<< "\tdataSetSizes[0] = dataSetSizes[1] = -1;\n";
+	for (int i = 0; i < numWorkingSets; i++) {
+		EvaluatorWorkingSet* workingSet = workingSets->at(i);
+		file << "\tisParallel[" << i << "] = " << workingSet->parallelLoop << ";\n";
+		if (workingSet->parallelLoop) {
+			/* Mirrors EvaluateParallelWorkingSetSize(). A parallel loop without
+			iterations yields no working set instead of an error. */
+			file << "\t{\n"
+				<< "\t\tlong numInstances = 1;\n";
+			for (int j = 0; j < workingSet->parallelLoopIndex; j++) {
+				file << "\t\tnumInstances *= threads[" << j << "];\n";
+			}
+
+			file << "\t\tlong numParallelIters = "
+				<< LowerUnionPwQpolynomialToC(workingSet->numParallelIters) << ";\n"
+				<< "\t\tlong dataSetUnionSize = "
+				<< LowerUnionPwQpolynomialToC(workingSet->dataSetUnionSize) << ";\n"
+				<< "\t\tlong dataSetCommonSize = "
+				<< LowerUnionPwQpolynomialToC(workingSet->dataSetCommonSize) << ";\n";
+
+			if (ignoreSizeOne) {
+				file << "\t\tif (numParallelIters == 1)\n\t\t\tnumParallelIters = -1;\n"
+					<< "\t\tif (dataSetUnionSize == 1)\n\t\t\tdataSetUnionSize = -1;\n"
+					<< "\t\tif (dataSetCommonSize == 1)\n\t\t\tdataSetCommonSize = -1;\n";
+			}
+
+			file << "\t\tif (dataSetUnionSize < 0)\n\t\t\tdataSetUnionSize = 0;\n"
+				<< "\t\tif (dataSetCommonSize < 0)\n\t\t\tdataSetCommonSize = 0;\n"
+				<< "\t\tminSizes[" << i << "] = maxSizes[" << i << "] = numParallelIters <= 0 ? -1 :\n"
+				<< "\t\t\t(long)((dataSetUnionSize - dataSetCommonSize) * numParallelIters / 2.0\n"
+				<< "\t\t\t+ dataSetCommonSize) * numInstances;\n"
+				<< "\t\tdataSetSizes[0] = max(dataSetSizes[0], dataSetUnionSize"
+				<< " * POLYSCIENTIST_DATATYPE_SIZE);\n"
+				<< "\t\tdataSetSizes[1] = max(dataSetSizes[1], dataSetCommonSize"
+				<< " * POLYSCIENTIST_DATATYPE_SIZE);\n"
+				<< "\t}\n";
+		}
+		else {
+			file << "\tminSizes[" << i << "] = "
+				<< LowerUnionPwQpolynomialToC(workingSet->minSize) << ";\n";
+			file << "\tmaxSizes[" << i << "] = "
+				<< LowerUnionPwQpolynomialToC(workingSet->maxSize) << ";\n";
+
+			if (ignoreSizeOne) {
+				file << "\tif (minSizes[" << i << "] == 1)\n\t\tminSizes["
+					<< i << "] = -1;\n";
+				file << "\tif (maxSizes[" << i << "] == 1)\n\t\tmaxSizes["
+					<< i << "] = -1;\n";
+			}
+		}
+	}
+	file << "\treturn numActiveThreads;\n}\n\n";
+
+	/* Mirrors ComputeSharedWorkingSetSize() */
+	bool doesParallelLoopExist = false;
+	for (int i = 0; i < numWorkingSets; i++) {
+		doesParallelLoopExist = doesParallelLoopExist || workingSets->at(i)->parallelLoop;
+	}
+
+	file << "static long polyscientist_shared_size(long size, long numSharers,\n"
+		<< "\tint isParallelLoopEncountered, const long *dataSetSizes)\n{\n"
+		<< "\tdouble commonFraction;\n\n"
+		<< "\tif (numSharers <= 1 || isParallelLoopEncountered)\n\t\treturn size;\n";
+	if (!doesParallelLoopExist) {
+		file << "\t(void)commonFraction;\n\t(void)dataSetSizes;\n"
+			<< "\treturn size * numSharers;\n}\n\n";
+	}
+	else {
+		file << "\tif (size >= 0.5 * dataSetSizes[0])\n"
+			<< "\t\treturn (size - dataSetSizes[1]) * numSharers + dataSetSizes[1];\n"
+			<< "\tcommonFraction = (double)dataSetSizes[1] / (double)dataSetSizes[0];\n"
+			<< "\treturn (1.0 - commonFraction) * size * numSharers + commonFraction * size;\n"
+			<< "}\n\n";
+	}
+
+	/* Mirrors ComputeActiveSockets() and ComputeSocketThreads() */
+	file << "static long polyscientist_socket_threads(long numThreads)\n{\n"
+		<< "\tlong numSockets = POLYSCIENTIST_SOCKETS;\n"
+		<< "\tlong socketCapacity = POLYSCIENTIST_CORES_PER_SOCKET\n"
+		<< "\t\t* max(POLYSCIENTIST_L1_SHARING_DEGREE, POLYSCIENTIST_L2_SHARING_DEGREE);\n\n"
+		<< "\tif (numSockets <= 1 || numThreads <= 1)\n\t\treturn numThreads;\n"
+		<< "\tif (socketCapacity > 0)\n"
+		<< "\t\tnumSockets = min(numSockets,\n"
+		<< "\t\t\t(numThreads + socketCapacity - 1) / socketCapacity);\n"
+		<< "\telse\n\t\tnumSockets = min(numSockets, numThreads);\n"
+		<< "\treturn (numThreads + numSockets - 1) / numSockets;\n}\n\n";
+
+	/* Mirrors ComputeSocketWorkingSetSize() */
+	file << "static long polyscientist_socket_size(long size, long socketThreads,\n"
+		<< "\tlong numThreads, int isParallelLoopEncountered, long dataSetCommonSize)\n{\n"
+		<< "\tlong commonSize;\n\n"
+		<< "\tif (!isParallelLoopEncountered || socketThreads >= numThreads || size <= 0)\n"
+		<< "\t\treturn size;\n"
+		<< "\tcommonSize = min(max(dataSetCommonSize, 0L), size);\n"
+		<< "\treturn commonSize + (size - commonSize) * socketThreads / numThreads;\n"
+		<< "}\n\n";
+
+	/* The pessimistic placement of the working sets mirrors
+	UpdatePessimisticProgramCharacteristics(), without the conflicts */
+	file << "static void polyscientist_place(long minSize, long maxSize,\n"
+		<< "\tint isParallelLoopEncountered, long numActiveThreads,\n"
+		<< "\tconst long *dataSetSizes, struct polyscientist_data_set_sizes *sizes)\n{\n"
+		<< "\tint minSizeSatisfied = 0, maxSizeSatisfied = 0;\n"
+		<< "\tlong L1Sharers = min(POLYSCIENTIST_L1_SHARING_DEGREE, numActiveThreads);\n"
+		<< "\tlong L2Sharers = min(POLYSCIENTIST_L2_SHARING_DEGREE, numActiveThreads);\n"
+		<< "\tlong L3Sharers = polyscientist_socket_threads(numActiveThreads);\n"
+		<< "\tlong L1MaxSize, L1MinSize, L2MaxSize, L2MinSize, L3MaxSize, L3MinSize;\n\n"
+		<< "\tminSize *= POLYSCIENTIST_DATATYPE_SIZE;\n"
+		<< "\tmaxSize *= POLYSCIENTIST_DATATYPE_SIZE;\n"
+		<< "\tif (minSize <= 0 || maxSize <= 0)\n\t\treturn;\n\n"
+		<< "\tL1MaxSize = polyscientist_shared_size(maxSize, L1Sharers,\n"
+		<< "\t\tisParallelLoopEncountered, dataSetSizes);\n"
+		<< "\tL1MinSize = polyscientist_shared_size(minSize, L1Sharers,\n"
+		<< "\t\tisParallelLoopEncountered, dataSetSizes);\n"
+		<< "\tL2MaxSize = polyscientist_shared_size(maxSize, L2Sharers,\n"
+		<< "\t\tisParallelLoopEncountered, dataSetSizes);\n"
+		<< "\tL2MinSize = polyscientist_shared_size(minSize, L2Sharers,\n"
+		<< "\t\tisParallelLoopEncountered, dataSetSizes);\n"
+		<< "\tL3MaxSize = polyscientist_socket_size(maxSize, L3Sharers,\n"
+		<< "\t\tnumActiveThreads, isParallelLoopEncountered, dataSetSizes[1]);\n"
+		<< "\tL3MinSize = polyscientist_socket_size(minSize, L3Sharers,\n"
+		<< "\t\tnumActiveThreads, isParallelLoopEncountered, dataSetSizes[1]);\n\n"
+		<< "\tif (L1MaxSize + sizes->L1 <= POLYSCIENTIST_L1) {\n"
+		<< "\t\tsizes->L1 += L1MaxSize;\n"
+		<< "\t\tminSizeSatisfied = maxSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!minSizeSatisfied && L1MinSize + sizes->L1 <= POLYSCIENTIST_L1) {\n"
+		<< "\t\tsizes->L1 += L1MinSize;\n"
+		<< "\t\tminSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!maxSizeSatisfied && L2MaxSize + sizes->L2 <= POLYSCIENTIST_L2) {\n"
+		<< "\t\tsizes->L2 += L2MaxSize;\n"
+		<< "\t\tminSizeSatisfied = maxSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!minSizeSatisfied && L2MinSize + sizes->L2 <= POLYSCIENTIST_L2) {\n"
+		<< "\t\tsizes->L2 += L2MinSize;\n"
+		<< "\t\tminSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!maxSizeSatisfied && L3MaxSize + sizes->L3 <= POLYSCIENTIST_L3) {\n"
+		<< "\t\tsizes->L3 += L3MaxSize;\n"
+		<< "\t\tminSizeSatisfied = maxSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!minSizeSatisfied && L3MinSize + sizes->L3 <= POLYSCIENTIST_L3) {\n"
+		<< "\t\tsizes->L3 += L3MinSize;\n"
+		<< "\t\tminSizeSatisfied = 1;\n\t}\n"
+		<< "\tif (!maxSizeSatisfied)\n"
+		<< "\t\tsizes->Mem += maxSize;\n}\n\n";
+
+	/* The working sets are deduplicated and sorted as in
+	SimplifyWorkingSetSizes() */
+	file << "void polyscientist_evaluate(const long *params,\n"
+		<< "\tstruct polyscientist_data_set_sizes *sizes)\n{\n"
+		<< "\tlong minSizes[" << arraySize << "], maxSizes[" << arraySize << "];\n"
+		<< "\tlong uniqueMinSizes[" << arraySize << "], uniqueMaxSizes["
+		<< arraySize << "];\n"
+		<< "\tint isParallel[" << arraySize << "], uniqueIsParallel[" << arraySize << "];\n"
+		<< "\tlong dataSetSizes[2];\n"
+		<< "\tlong numActiveThreads;\n"
+		<< "\tint isParallelLoopEncountered = 0;\n"
+		<< "\tint numUnique = 0;\n"
+		<< "\tint i, j;\n\n"
+		<< "\tnumActiveThreads = polyscientist_working_set_sizes(params, minSizes, maxSizes,\n"
+		<< "\t\tisParallel, dataSetSizes);\n"
+		<< "\tfor (i = 0; i < POLYSCIENTIST_NUM_WORKING_SETS; i++) {\n"
+		<< "\t\tlong minSize = minSizes[i], maxSize = maxSizes[i];\n"
+		<< "\t\tif (minSize == -1 || maxSize == -1 || minSize == 0 || maxSize == 0)\n"
+		<< "\t\t\tcontinue;\n"
+		<< "\t\tfor (j = 0; j < numUnique; j++)\n"
+		<< "\t\t\tif (uniqueMinSizes[j] == minSize && uniqueMaxSizes[j] == maxSize)\n"
+		<< "\t\t\t\tbreak;\n"
+		<< "\t\tif (j < numUnique)\n"
+		<< "\t\t\tcontinue;\n"
+		<< "\t\tfor (j = numUnique; j > 0 && (uniqueMinSizes[j - 1] > minSize ||\n"
+		<< "\t\t\t(uniqueMinSizes[j - 1] == minSize && uniqueMaxSizes[j - 1] > maxSize)); j--) {\n"
+		<< "\t\t\tuniqueMinSizes[j] = uniqueMinSizes[j - 1];\n"
+		<< "\t\t\tuniqueMaxSizes[j] = uniqueMaxSizes[j - 1];\n"
+		<< "\t\t\tuniqueIsParallel[j] = uniqueIsParallel[j - 1];\n"
+		<< "\t\t}\n"
+		<< "\t\tuniqueMinSizes[j] = minSize;\n"
+		<< "\t\tuniqueMaxSizes[j] = maxSize;\n"
+		<< "\t\tuniqueIsParallel[j] = isParallel[i];\n"
+		<< "\t\tnumUnique++;\n"
+		<< "\t}\n\n"
+		<< "\tsizes->L1 = sizes->L2 = sizes->L3 = sizes->Mem = 0;\n"
+		<< "\tfor (i = 0; i < numUnique; i++) {\n"
+		<< "\t\tisParallelLoopEncountered = isParallelLoopEncountered || uniqueIsParallel[i];\n"
+		<< "\t\tpolyscientist_place(uniqueMinSizes[i], uniqueMaxSizes[i],\n"
+		<< "\t\t\tisParallelLoopEncountered, numActiveThreads, dataSetSizes, sizes);\n"
+		<< "\t}\n"
+		<< "}\n\n";
+
+	file << "void polyscientist_evaluate_table(const long *params, long numRows,\n"
+		<< "\tstruct polyscientist_data_set_sizes *sizes)\n{\n"
+		<< "\tlong i;\n\n"
+		<< "\tfor (i = 0; i < numRows; i++)\n"
+		<< "\t\tpolyscientist_evaluate(params + i * POLYSCIENTIST_NUM_PARAMETERS,\n"
+		<< "\t\t\tsizes + i);\n"
+		<< "}\n";
+
+	file.close();
+}
+
+void CollectParameterNames(isl_union_pw_qpolynomial* polynomial,
+	vector<string>* names) {
+	isl_space* space = isl_union_pw_qpolynomial_get_space(polynomial);
+	isl_size numParams = isl_space_dim(space, isl_dim_param);
+	for (int i = 0; i < numParams; i++) {
+		names->push_back(isl_space_get_dim_name(space, isl_dim_param, i));
+	}
+
+	isl_space_free(space);
+}
+
+void EmitParameterDeclarations(ofstream& file, vector<string>* names) {
+	for (int i = 0; i < names->size(); i++) {
+		file << "\tconst long " << names->at(i) << " = params[" << i << "];\n";
+	}
+
+	for (int i = 0; i < names->size(); i++) {
+		file << "\t(void)" << names->at(i) << ";\n";
+	}
+}
+
+string LowerUnionPwQpolynomialToC(isl_union_pw_qpolynomial* polynomial) {
+	/* The pieces of a piecewise quasi-polynomial are disjoint and a point
+	outside all of them evaluates to zero, as in EvaluateUnionPwQpolynomial() */
+	PolynomialLowering* lowering = new PolynomialLowering;
+	lowering->pieces = new vector<string>();
+	lowering->isLowered = true;
+
+	if (isl_union_pw_qpolynomial_foreach_pw_qpolynomial(polynomial,
+		&LowerPwQpolynomialToC, lowering) < 0) {
+		lowering->isLowered = false;
+	}
+
+	string expr;
+	if (!lowering->isLowered || lowering->pieces->size() == 0) {
+		expr = "-1L";
+	}
+	else {
+		for (int i = 0; i < lowering->pieces->size(); i++) {
+			expr += (i == 0 ? "" : " +\n\t\t") + lowering->pieces->at(i);
+		}
+	}
+
+	delete lowering->pieces;
+	delete lowering;
+	return expr;
+}
+
+isl_stat LowerPwQpolynomialToC(isl_pw_qpolynomial *pwqp, void *user) {
+	PolynomialLowering* lowering = (PolynomialLowering*)user;
+	isl_stat stat = isl_stat_error;
+
+	if (isl_pw_qpolynomial_dim(pwqp, isl_dim_in) == 0) {
+		if (isl_pw_qpolynomial_is_zero(pwqp) == isl_bool_true) {
+			lowering->pieces->push_back("0L");
+			stat = isl_stat_ok;
+		}
+		else {
+			stat = isl_pw_qpolynomial_foreach_piece(pwqp, &LowerPieceToC,
+				lowering);
+		}
+	}
+
+	isl_pw_qpolynomial_free(pwqp);
+	return stat;
+}
+
+isl_stat LowerPieceToC(isl_set *set, isl_qpolynomial *qp, void *user) {
+	PolynomialLowering* lowering = (PolynomialLowering*)user;
+	string condition = LowerSetToC(set);
+	string value = LowerQpolynomialToC(qp);
+	isl_qpolynomial_free(qp);
+
+	if (condition.empty() || value.empty()) {
+		return isl_stat_error;
+	}
+
+	lowering->pieces->push_back("((" + condition + ") ? (" + value + ") : 0L)");
+	return isl_stat_ok;
+}
+
+string LowerSetToC(isl_set* set) {
+	isl_ast_build* build = isl_ast_build_from_context(
+		isl_set_universe(isl_space_params(isl_set_get_space(set))));
+	isl_ast_expr* expr = isl_ast_build_expr_from_set(build, isl_set_params(set));
+	isl_ast_build_free(build);
+
+	if (!expr) {
+		return "";
+	}
+
+	char* str = isl_ast_expr_to_C_str(expr);
+	string condition(str);
+	free(str);
+	isl_ast_expr_free(expr);
+	return condition;
+}
+
+string LowerPwAffToC(isl_pw_aff* pwaff) {
+	isl_ast_build* build = isl_ast_build_from_context(
+		isl_set_universe(isl_space_params(isl_pw_aff_get_domain_space(pwaff))));
+	isl_ast_expr* expr = isl_ast_build_expr_from_pw_aff(build, pwaff);
+	isl_ast_build_free(build);
+
+	if (!expr) {
+		return "";
+	}
+
+	char* str = isl_ast_expr_to_C_str(expr);
+	string aff(str);
+	free(str);
+	isl_ast_expr_free(expr);
+	return aff;
+}
+
+string LowerQpolynomialToC(isl_qpolynomial* qp) {
+	/* A quasi-polynomial is a sum of terms with rational coefficients over
+	the parameters and integer divisions of affine expressions. The terms are
+	brought to a common denominator so that the division is exact and is
+	performed once. */
+	TermLowering* lowering = new TermLowering;
+	lowering->paramNames = new vector<string>();
+	lowering->monomials = new vector<string>();
+	lowering->numerators = new vector<long>();
+	lowering->denominators = new vector<long>();
+	lowering->isLowered = true;
+
+	isl_space* space = isl_qpolynomial_get_domain_space(qp);
+	isl_size numParams = isl_space_dim(space, isl_dim_param);
+	for (int i = 0; i < numParams; i++) {
+		lowering->paramNames->push_back(
+			isl_space_get_dim_name(space, isl_dim_param, i));
+	}
+
+	isl_space_free(space);
+
+	if (isl_qpolynomial_foreach_term(qp, &LowerTermToC, lowering) < 0) {
+		lowering->isLowered = false;
+	}
+
+	string expr;
+	if (lowering->isLowered) {
+		long denominator = 1;
+		for (int i = 0; i < lowering->denominators->size(); i++) {
+			long d = lowering->denominators->at(i);
+			denominator = denominator / ComputeGcd(denominator, d) * d;
+		}
+
+		expr = "0L";
+		for (int i = 0; i < lowering->monomials->size(); i++) {
+			long coefficient = lowering->numerators->at(i) *
+				(denominator / lowering->denominators->at(i));
+			expr += " + " + to_string(coefficient) + "L" +
+				lowering->monomials->at(i);
+		}
+
+		if (denominator != 1) {
+			expr = "(" + expr + ") / " + to_string(denominator) + "L";
+		}
+	}
+
+	delete lowering->paramNames;
+	delete lowering->monomials;
+	delete lowering->numerators;
+	delete lowering->denominators;
+	delete lowering;
+	return expr;
+}
+
+isl_stat LowerTermToC(isl_term *term, void *user) {
+	TermLowering* lowering = (TermLowering*)user;
+
+	isl_val* coefficient = isl_term_get_coefficient_val(term);
+	lowering->numerators->push_back(isl_val_get_num_si(coefficient));
+	lowering->denominators->push_back(isl_val_get_den_si(coefficient));
+	isl_val_free(coefficient);
+
+	string monomial;
+	isl_size numParams = isl_term_dim(term, isl_dim_param);
+	for (int i = 0; i < numParams; i++) {
+		int exponent = isl_term_get_exp(term, isl_dim_param, i);
+		for (int j = 0; j < exponent; j++) {
+			monomial += " * " + lowering->paramNames->at(i);
+		}
+	}
+
+	isl_size numDivs = isl_term_dim(term, isl_dim_div);
+	for (int i = 0; i < numDivs; i++) {
+		int exponent = isl_term_get_exp(term, isl_dim_div, i);
+		if (exponent == 0) {
+			continue;
+		}
+
+		string div = LowerPwAffToC(isl_pw_aff_from_aff(
+			isl_term_get_div(term, i)));
+		if (div.empty()) {
+			lowering->isLowered = false;
+			isl_term_free(term);
+			return isl_stat_error;
+		}
+
+		for (int j = 0; j < exponent; j++) {
+			monomial += " * (" + div + ")";
+		}
+	}
+
+	lowering->monomials->push_back(monomial);
+	isl_term_free(term);
+	return isl_stat_ok;
+}
@@ -0,0 +1,40 @@
+#ifndef EVALUATOR_EMITTER_HPP
+#define EVALUATOR_EMITTER_HPP
+
+#include <barvinok/isl.h>
+#include <ConfigProcessor.hpp>
+#include <string>
+#include <vector>
+
+/* The polynomials of one working set as seen by the emitted evaluator. The
+working set of a dependence that spans the iterations of a parallel loop is
+computed from the sizes of the data sets of two of its iterations and its
+number of iterations. */
+struct EvaluatorWorkingSet {
+	isl_union_pw_qpolynomial* minSize;
+	isl_union_pw_qpolynomial* maxSize;
+	bool parallelLoop;
+	isl_union_pw_qpolynomial* dataSetUnionSize;
+	isl_union_pw_qpolynomial* dataSetCommonSize;
+	isl_union_pw_qpolynomial* numParallelIters;
+	int parallelLoopIndex;
+};
+
+typedef struct EvaluatorWorkingSet EvaluatorWorkingSet;
+
+/* How the threads are split across the parallel loops. The trip counts are
+NULL unless the split is derived from them. */
+struct EvaluatorParallelLoops {
+	std::vector<int>* threads;
+	std::vector<isl_union_pw_qpolynomial*>* tripCounts;
+	int numProcs;
+};
+
+typedef struct EvaluatorParallelLoops EvaluatorParallelLoops;
+
+void EmitEvaluator(std::string fileName, std::string inputFile,
+	std::vector<EvaluatorWorkingSet*>* workingSets,
+	isl_union_pw_qpolynomial* totalDataSetSize,
+	EvaluatorParallelLoops* parallelLoops, SystemConfig* systemConfig, int datatypeSize, bool ignoreSizeOne);
+
+#endif
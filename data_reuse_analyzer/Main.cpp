@@ -14,12 +14,28 @@
 #include <ConfigProcessor.hpp>
 #include <OptionsProcessor.hpp>
 #include <Utility.hpp>
+#include <AnalysisCache.hpp>
+#include <PolynomialEvaluator.hpp>
+#include <EvaluatorEmitter.hpp>
+#include <Profiler.hpp>
+#include <AnalysisBudget.hpp>
+#include <CacheSimulator.hpp>
+#include <Scop.hpp>
+#include <ScopSnapshot.hpp>
+#include <PolyScientist.hpp>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
 using namespace std;
 
 
 #define IGNORE_WS_SIZE_ONE 1
 #define DEBUG 0
+/* The working sets of the threads sharing an L3 cache are not scaled by the
+number of threads at L3. Only the working sets spanning the parallel loop are
+split, across the sockets, by ComputeSocketWorkingSetSize(). */
 #define SCALEDATASETSIZEATL3 0
 
 #define min(X, Y) (((X) < (Y)) ? (X) : (Y))
@@ -39,10 +55,55 @@ struct WorkingSetSize {
 	long size;
 	long dataSetUnionCardInt;
 	long dataSetCommonCardInt;
+	/* For a dependence that spans the iterations of a parallel loop, the
+	parametric sizes from which size, dataSetUnionCardInt, and
+	dataSetCommonCardInt are evaluated for each row of parameter values */
+	isl_union_pw_qpolynomial* dataSetUnionSize;
+	isl_union_pw_qpolynomial* dataSetCommonSize;
+	isl_union_pw_qpolynomial* numParallelIters;
+	/* The position, in the parallel loops of the config, of the parallel loop
+	whose iterations the dependence spans. -1 for other dependences. */
+	int parallelLoopIndex;
+	/* The dimensions of every array that vary in the largest data set of the
+	working set, e.g., "A:011 B:11", from which the conflicts in set-associative
+	caches are estimated. NULL when the associativity of no cache is known. */
+	string* conflictSignature;
+	/* The number of values each dimension of every array takes in the largest
+	data set, in the spaces <array>__dim<dimension>, from which the pages of
+	the working set are estimated. NULL unless the TLBs are modeled. For a
+	dependence that spans the iterations of a parallel loop, they are the
+	values accessed in one iteration, i.e., by one thread. */
+	isl_union_pw_qpolynomial* indexCounts;
+	/* The number of data units of every array in the largest data set, in the
+	spaces <array>[], from which the data of the working set are split by array.
+	NULL unless the per-array statistics are written. */
+	isl_union_pw_qpolynomial* arraySizes;
+	/* Whether the analysis of the dependence exceeded its budget, so that its
+	data sets are bounded by boxes instead of being counted */
+	bool approximate;
+	/* The accesses, as pairs of a statement instance and a data unit, whose
+	data were accessed before by the source of the dependence. NULL unless the
+	memory traffic is modeled. */
+	isl_union_map* reusedAccesses;
+	/* The number of accesses to every array that reuse the data of the source
+	of the dependence, in the spaces <array>[], by which its reuse distances are
+	weighted. NULL unless the reuse distance histograms are written. */
+	isl_union_pw_qpolynomial* reusePairs;
 };
 
 typedef struct WorkingSetSize WorkingSetSize;
 
+/* The working set in which the features of a data set are recorded, besides
+its size, and which of them */
+struct DataSetFeatureRecorder {
+	WorkingSetSize* workingSetSize;
+	bool conflictSignature;
+	bool indexCounts;
+	bool arraySizes;
+};
+
+typedef struct DataSetFeatureRecorder DataSetFeatureRecorder;
+
 struct ProgramCharacteristics {
 	int L1Fit; // #working sets that fit in L1 cache
 	int L2Fit; // #working sets that fit in L2 cache
@@ -57,6 +118,11 @@ struct ProgramCharacteristics {
 	long PessiL2DataSetSize;
 	long PessiL3DataSetSize;
 	long PessiMemDataSetSize;
+	/* The capacity of each cache taken by the working sets placed in it,
+	including the lines lost to conflicts */
+	long PessiL1Occupancy;
+	long PessiL2Occupancy;
+	long PessiL3Occupancy;
 };
 
 typedef struct ProgramCharacteristics ProgramCharacteristics;
@@ -67,26 +133,150 @@ struct MinMaxTuple {
 	bool isParallelLoopEncountered;
 	long dataSetUnionCardInt;
 	long dataSetCommonCardInt;
+	/* The factors by which the working set is inflated by the conflicts in the
+	L1, L2 and L3 caches */
+	double conflictFactors[3];
+	/* The first working set of the sizes, whose data are split by array in the
+	per-array statistics */
+	WorkingSetSize* workingSetSize;
+	/* The level, 0 to 3 for L1, L2, L3 and the memory, in which the largest
+	working set of the sizes is placed. -1 until it is placed. */
+	int level;
 };
 
 typedef struct MinMaxTuple MinMaxTuple;
 
+/* The bytes of an array placed in the L1, L2, L3 caches and the memory, and
+the number of working sets that reuse its data from each of them */
+struct ArrayResidency {
+	double bytes[4];
+	int reuses[4];
+};
+
+typedef struct ArrayResidency ArrayResidency;
+
 void GetSystemAndProgramCharacteristics(SystemConfig* systemConfig,
 	ProgramCharacteristics* programChar);
 void InitializeProgramCharacteristics(ProgramCharacteristics* programChar);
 void UpdateProgramCharacteristics(long size, SystemConfig* systemConfig,
 	ProgramCharacteristics* programChar);
 
+/* The dependences (basic maps) seen so far, bucketed by the hash of their
+canonical form. Equal dependences have the same working sets, so the working
+sets of a dependence equal to one seen before are not computed again. */
+struct DependenceDeduplication {
+	unordered_map<size_t, vector<isl_basic_map*>*>* dependences;
+	int numDependences;
+	int numDuplicates;
+};
+
+typedef struct DependenceDeduplication DependenceDeduplication;
+
+struct DataUnitMapping {
+	Config* config;
+	isl_union_map* dataUnitMap;
+};
+
+typedef struct DataUnitMapping DataUnitMapping;
+
 struct ArgComputeWorkingSetSizesForDependence {
-	pet_scop *scop;
+	Scop* scop;
 	vector<WorkingSetSize*>* workingSetSizes;
 	isl_union_map* may_reads;
 	isl_union_map* may_writes;
+	isl_union_map* schedule;
 	Config* config;
+	DependenceDeduplication* deduplication;
 };
 
 typedef struct ArgComputeWorkingSetSizesForDependence  ArgComputeWorkingSetSizesForDependence;
 
+/* A WorkingSetSize in its textual form. It is used to move the working sets
+computed by a worker thread, in its own isl_ctx, to the main isl_ctx. */
+struct SerializedWorkingSetSize {
+	string dependence;
+	string source;
+	string target;
+	string minTarget;
+	string maxTarget;
+	string minSize;
+	string maxSize;
+	bool parallelLoop;
+	string dataSetUnionSize;
+	string dataSetCommonSize;
+	string numParallelIters;
+	int parallelLoopIndex;
+	string conflictSignature;
+	string indexCounts;
+	string arraySizes;
+	bool approximate;
+	string reusedAccesses;
+	string reusePairs;
+};
+
+typedef struct SerializedWorkingSetSize SerializedWorkingSetSize;
+
+/* The number of records a SerializedWorkingSetSize is stored as in the
+analysis cache */
+#define WORKING_SET_SIZE_RECORDS 18
+
+struct WorkingSetSizeJob {
+	int arrayId;
+	isl_basic_map* dependence;
+	string dependenceString;
+	SerializedWorkingSetSize* result;
+};
+
+typedef struct WorkingSetSizeJob WorkingSetSizeJob;
+
+struct WorkingSetSizeJobQueue {
+	vector<WorkingSetSizeJob*>* jobs;
+	unordered_map<int, string>* may_reads;
+	unordered_map<int, string>* may_writes;
+	string schedule;
+	Config* config;
+	atomic<int> next;
+};
+
+typedef struct WorkingSetSizeJobQueue WorkingSetSizeJobQueue;
+
+/* The schedule map being padded so that all the statements are scheduled in
+a common space of numDims dimensions */
+struct SchedulePadding {
+	int numDims;
+	isl_union_map* paddedSchedule;
+};
+
+typedef struct SchedulePadding SchedulePadding;
+
+struct ArgCollectWorkingSetSizeJobs {
+	int arrayId;
+	vector<WorkingSetSizeJob*>* jobs;
+	DependenceDeduplication* deduplication;
+};
+
+typedef struct ArgCollectWorkingSetSizeJobs ArgCollectWorkingSetSizeJobs;
+
+struct InputFileQueue {
+	vector<string>* inputFiles;
+	vector<string>* stats;
+	vector<string>* arrayStats;
+	vector<string>* reuseHistograms;
+	vector<vector<string>>* polyRankGroups;
+	UserInput* userInput;
+	Config* config;
+	atomic<int> next;
+};
+
+typedef struct InputFileQueue InputFileQueue;
+
+/* pet extracts the scop using clang, which is not safe to run concurrently */
+mutex parseScopMutex;
+
+/* Whether the data sets of the dependence analyzed by the current thread are
+bounded by boxes instead of being counted */
+thread_local bool boundDataSetCards = false;
+
 struct ArrayDataAccesses {
 	isl_union_map* may_reads;
 	isl_union_map* may_writes;
@@ -95,6 +285,19 @@ struct ArrayDataAccesses {
 
 typedef struct ArrayDataAccesses ArrayDataAccesses;
 
+struct PolyScientistContext {
+	isl_ctx* ctx;
+	/* The source of the scop, a C file or a scop snapshot */
+	string source;
+	Scop* scop;
+	/* The dependences and the working sets of the scop, and the keys of the
+	analysis cache for the options they were computed for */
+	string dependencesKey;
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap;
+	string workingSetSizesKey;
+	vector<WorkingSetSize*>* workingSetSizes;
+};
+
 struct DimPositions {
 	int input;
 	int output;
@@ -114,18 +317,33 @@ struct ParallelDependenceDetectionData {
 typedef struct ParallelDependenceDetectionData ParallelDependenceDetectionData;
 
 void ComputeDataReuseWorkingSets(UserInput *userInput, Config *config);
-pet_scop* ParseScop(isl_ctx* ctx, const char *fileName);
+Scop* ParseScop(isl_ctx* ctx, const char *fileName);
+Scop* LoadScop(isl_ctx* ctx, UserInput *userInput, string* dependencesKey,
+	vector<string>* dependenceRecords);
 isl_stat ComputeWorkingSetSizesForDependence(isl_map* dep, void *user);
 isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 	void *user);
+WorkingSetSize* ComputeWorkingSetSizeOfDependence(isl_basic_map* dep,
+	ArgComputeWorkingSetSizesForDependence* arg);
+isl_stat ComputeWorkingSetSizesForUniqueDependenceBasicMap(isl_basic_map* dep,
+	void *user);
 isl_union_pw_qpolynomial* ComputeDataSetSize(isl_union_set* WS,
-	isl_union_map *may_reads, isl_union_map *may_writes);
+	isl_union_map *may_reads, isl_union_map *may_writes,
+	DataSetFeatureRecorder* recorder);
 void FreeWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes);
 void PrintWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes);
 void SimplifyWorkingSetSizesInteractively(vector<WorkingSetSize*>* workingSetSizes,
 	UserInput *userInput, Config *config);
 void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
-	UserInput *userInput, Config *config, pet_scop *scop);
+	UserInput *userInput, Config *config, Scop* scop);
+void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
+	UserInput *userInput, Config *config, Scop* scop, ostream& file,
+	string rowPrefix, ostream* arrayFile, ostream* histogramFile,
+	vector<string>* polyRankGroups, vector<DataSetSizes>* dataSetSizes);
+void WriteWorkingSetSizesHeader(UserInput *userInput, Config *config,
+	ostream& file,
+	string prefixHeader);
+void WriteArrayStatsHeader(ostream& file, string prefixHeader);
 string SimplifyUnionPwQpolynomial(isl_union_pw_qpolynomial* size,
 	unordered_map<string, int>* paramValues);
 unordered_map<string, int>* GetParameterValues(vector<WorkingSetSize*>* workingSetSizes);
@@ -134,7 +352,6 @@ long ExtractIntegerFromUnionPwQpolynomial(isl_union_pw_qpolynomial* poly);
 string GetParameterValuesString(unordered_map<string, int>* paramValues);
 isl_union_map* ComputeDataDependences(isl_union_map *source,
 	isl_union_map *target, isl_schedule* schedule);
-void OrchestrateDataReuseComputation(int argc, char **argv);
 string ExtractFileName(string fileName);
 MinMaxTuple* AddToVectorIfUniqueDependence(vector<MinMaxTuple*> *minMaxTupleVector,
 	long min, long max, bool isParallelLoopEncountered);
@@ -149,23 +366,33 @@ void UpdatePessimisticProgramCharacteristics(long minSize, long maxSize,
 	bool doesParallelLoopExist,
 	SystemConfig* systemConfig,
 	ProgramCharacteristics* programChar,
-	int numProcs, long totalDataSetSize, long dataSetUnionCardInt, long dataSetCommonCardInt);
+	int numProcs, long totalDataSetSize, long dataSetUnionCardInt, long dataSetCommonCardInt,
+	double* conflictFactors);
+long ComputeSharedWorkingSetSize(long size, int numSharers,
+	bool isParallelLoopEncountered, bool doesParallelLoopExist,
+	long dataSetUnionCardInt, long dataSetCommonCardInt);
 bool compareByMinMaxSize(const MinMaxTuple* a, const MinMaxTuple* b);
 vector<WorkingSetSize*>* ComputeWorkingSetSizesForDependences(
 	UserInput *userInput,
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
-	pet_scop *scop, Config *config);
+	Scop* scop, Config *config);
 ArrayDataAccesses* ComputeAllDataDependences(isl_union_map* may_reads,
 	isl_union_map* may_writes, isl_schedule* schedule);
 unordered_map<int, ArrayDataAccesses*>* ComputeDataDependences(
 	UserInput *userInput,
-	isl_ctx* ctx, pet_scop* scop,
+	isl_ctx* ctx, Scop* scop,
 	Config *config);
 void FreeDependenceMap(
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap);
 isl_union_pw_qpolynomial* ComputeDataSetSize(isl_basic_set* sourceDomain,
 	isl_set* source, isl_set* target, isl_union_map* may_reads,
-	isl_union_map* may_writes);
+	isl_union_map* may_writes, DataSetFeatureRecorder* recorder);
+isl_union_pw_qpolynomial* ComputeScheduledDataSetSize(isl_union_map* schedule,
+	isl_set* source, isl_set* target, isl_union_map* may_reads,
+	isl_union_map* may_writes, DataSetFeatureRecorder* recorder);
+isl_union_map* ComputePaddedScheduleMap(Scop* scop);
+isl_stat FindMaxScheduleDims(isl_map* map, void* user);
+isl_stat PadScheduleMap(isl_map* map, void* user);
 void RecognizeParallelIterationSpanningDependences(
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
 	Config *config);
@@ -196,33 +423,184 @@ vector<string>* GetLoopVariables(isl_basic_map *deps, int firstIn, int nIn, int
 bool DoesLoopVariableOccurInInqualityConstraints(isl_basic_map *deps, const char* loopVar);
 int FindThePositionOfTheLoopVariable(isl_basic_set *bset,
 	vector<string> *parallelLoops);
-isl_basic_set* ProjectBSetToLexExtreme(isl_basic_set* sourceDomain,
+isl_set* ProjectBSetToLexExtreme(isl_basic_set* sourceDomain,
 	isl_set* sourceDomainLexExtreme, int pos);
 void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 	isl_union_map* may_reads,
-	isl_union_map* may_writes, Config* config, isl_basic_set* domain, int pos,
-	WorkingSetSize* workingSetSize);
+	isl_union_map* may_writes, isl_set* domain, int pos,
+	WorkingSetSize* workingSetSize, DataSetFeatureRecorder* recorder);
+void EvaluateParallelWorkingSetSize(WorkingSetSize* workingSetSize,
+	ParameterBinding* binding, unordered_map<string, int>* paramValues,
+	vector<long>* parallelLoopThreads);
+vector<isl_union_pw_qpolynomial*>* ComputeParallelLoopTripCounts(
+	Scop* scop, Config* config);
+isl_union_pw_qpolynomial* ComputeParallelLoopTripCount(Scop* scop,
+	string parallelLoop);
+void FreeParallelLoopTripCounts(
+	vector<isl_union_pw_qpolynomial*>* tripCounts);
+long ComputeParallelLoopThreads(Config* config, int numProcs,
+	vector<isl_union_pw_qpolynomial*>* tripCounts, ParameterBinding* binding,
+	unordered_map<string, int>* paramValues, vector<long>* parallelLoopThreads);
 isl_union_set* SimplifyUnionSet(isl_union_set* set,
 	unordered_map<string, int>* paramValues);
-long ComputeNumberOfItersInParallelLoop(isl_basic_set* bset, int pos,
-	unordered_map<string, int>* paramValues);
+isl_union_pw_qpolynomial* ComputeNumberOfItersInParallelLoop(
+	isl_set* set, int pos);
 isl_basic_set* SimplifyBasicSet(isl_basic_set* bset,
 	unordered_map<string, int>* paramValues);
-isl_union_pw_qpolynomial* ComputeTotalDataSetSize(pet_scop *scop);
+isl_union_pw_qpolynomial* ComputeTotalDataSetSize(Scop* scop,
+	Config *config);
 void PrintWorkingSetSize(WorkingSetSize* wss);
+void FreeWorkingSetSize(WorkingSetSize* workingSetSize);
+void ComputeWorkingSetSizesForDependencesInParallel(
+	UserInput *userInput,
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	isl_union_map* schedule,
+	Config *config, vector<WorkingSetSize*>* workingSetSizes);
+isl_stat CollectWorkingSetSizeJobsForDependence(isl_map* dep, void *user);
+isl_stat CollectWorkingSetSizeJobForDependenceBasicMap(isl_basic_map* dep,
+	void *user);
+void ComputeWorkingSetSizesWorker(WorkingSetSizeJobQueue* queue);
+SerializedWorkingSetSize* SerializeWorkingSetSize(WorkingSetSize* workingSetSize);
+WorkingSetSize* DeserializeWorkingSetSize(isl_basic_map* dependence,
+	SerializedWorkingSetSize* serializedWorkingSetSize);
+void ComputeDataReuseWorkingSetsForInputList(UserInput *userInput,
+	Config *config);
+void ComputeDataReuseWorkingSetsWorker(InputFileQueue* queue);
+void WritePolyRankVariants(string fileName, vector<string>* inputFiles,
+	vector<vector<string>>* polyRankGroups, Config *config);
+string ComputeDataReuseWorkingSetsForInputFile(isl_ctx* ctx, string inputFile,
+	UserInput *userInput, Config *config, string* arrayStats,
+	string* reuseHistograms, vector<string>* polyRankGroups);
+long EvaluateWorkingSetSize(isl_union_pw_qpolynomial* size,
+	ParameterBinding* binding, unordered_map<string, int>* paramValues);
+void EmitWorkingSetEvaluator(vector<WorkingSetSize*>* workingSetSizes,
+	UserInput *userInput, Config *config, Scop* scop);
+void BenchmarkPolynomialEvaluation(vector<WorkingSetSize*>* workingSetSizes,
+	Config *config, Scop* scop);
+string GetSortedParameterValuesString(unordered_map<string, int>* paramValues);
+vector<int> GetSortedArrayIds(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap);
+string GetDependencesCacheKey(UserInput *userInput, Scop* scop,
+	Config *config);
+string GetWorkingSetSizesCacheKey(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	isl_union_map* schedule, Config *config);
+unordered_map<int, ArrayDataAccesses*>* ReadDependenceMapFromCache(
+	isl_ctx* ctx, string cacheDir, string key);
+void WriteDependenceMapToCache(string cacheDir, string key,
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap);
+unordered_map<int, ArrayDataAccesses*>* DeserializeDependenceMap(
+	isl_ctx* ctx, vector<string>* records);
+void SerializeDependenceMap(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	vector<string>* records);
+vector<WorkingSetSize*>* ReadWorkingSetSizesFromCache(isl_ctx* ctx,
+	string cacheDir, string key);
+void WriteWorkingSetSizesToCache(string cacheDir, string key,
+	vector<WorkingSetSize*>* workingSetSizes);
+void AppendWorkingSetSizeRecords(
+	SerializedWorkingSetSize* serializedWorkingSetSize, vector<string>* records);
+SerializedWorkingSetSize* ReadWorkingSetSizeRecords(vector<string>* records,
+	int pos);
+DependenceDeduplication* CreateDependenceDeduplication();
+bool IsDuplicateDependence(DependenceDeduplication* deduplication,
+	isl_basic_map* dep);
+void ClearDependenceDeduplication(DependenceDeduplication* deduplication);
+void FreeDependenceDeduplication(DependenceDeduplication* deduplication);
+void ReportDependenceDeduplication(DependenceDeduplication* deduplication);
+isl_union_pw_qpolynomial* ComputeUnionSetCard(isl_union_set* set);
+int GetDataUnitSize(Config *config);
+isl_union_map* MapAccessesToDataUnits(isl_union_map* accesses,
+	Config *config);
+isl_stat AddDataUnitMapForArray(isl_set* array, void* user);
+isl_map* MapElementsToBytes(isl_space* space, int numDims, long datatypeSize);
+bool IsConflictModeled(SystemConfig* systemConfig);
+string* ComputeConflictSignature(isl_union_set* dataSet);
+isl_stat AddArrayToConflictSignature(isl_set* array, void* user);
+unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* ComputeArrayExtents(
+	Scop* scop);
+void FreeArrayExtents(
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents);
+void EvaluateArrayExtents(
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents,
+	ParameterBinding* binding,
+	unordered_map<string, vector<long>>* arrayExtentValues);
+void ComputeConflictFactors(string* conflictSignature,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	Config* config, double* conflictFactors);
+long ComputeUsableCacheSets(long numSets, long lineSize, vector<long>* extents,
+	string varyingDims, long elementSize);
+long ApplyConflictFactor(long size, double* conflictFactors, int level);
+void RecordDataSetFeatures(isl_union_set* dataSet,
+	DataSetFeatureRecorder* recorder);
+isl_union_pw_qpolynomial* ComputeIndexCounts(isl_union_set* dataSet);
+isl_union_pw_qpolynomial* ComputeUnionMapCard(isl_union_map* map);
+isl_stat AddArrayIndexValues(isl_set* array, void* user);
+isl_stat EvaluateIndexCount(isl_pw_qpolynomial* indexCount, void* user);
+long ComputeWorkingSetPages(WorkingSetSize* workingSetSize,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	ParameterBinding* binding, Config* config);
+long ComputePageFootprint(vector<long>* indexCounts, vector<long>* extents,
+	long elementSize, long pageSize);
+void ComputeTLBFit(vector<WorkingSetSize*>* workingSetSizes,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	ParameterBinding* binding, Config* config, long* pages);
+isl_union_pw_qpolynomial* ComputeArraySizes(isl_union_set* dataSet);
+isl_union_map* MapArrayNamesToData(isl_union_set* dataSet);
+isl_stat AddArrayNameToData(isl_set* array, void* user);
+void EvaluateArraySizes(isl_union_pw_qpolynomial* arraySizes,
+	ParameterBinding* binding, unordered_map<string, long>* arraySizeValues);
+isl_stat EvaluateArraySize(isl_pw_qpolynomial* arraySize, void* user);
+void AddArrayResidencies(MinMaxTuple* minMaxTuple, long* placedBytes,
+	ParameterBinding* binding, map<string, ArrayResidency>* residencies);
+bool IsDependenceBudgeted(Config* config);
+isl_union_pw_qpolynomial* ComputeDataSetCard(isl_union_set* dataSet);
+isl_union_pw_qpolynomial* ComputeDataMapCard(isl_union_map* map);
+isl_stat AddBoundingBoxCard(isl_map* map, void* user);
+isl_stat AddCardOnParams(isl_pw_qpolynomial* card, void* user);
+isl_pw_qpolynomial* ComputeBoundingBoxCard(isl_map* map);
+isl_union_map* ComputeReusedAccesses(isl_basic_map* dep,
+	isl_union_map* may_reads, isl_union_map* may_writes);
+void ComputeTraffic(vector<WorkingSetSize*>* workingSetSizes,
+	vector<MinMaxTuple*>* workingSetTuples, isl_union_map* reads,
+	isl_union_map* writes, unordered_map<string, int>* paramValues,
+	ParameterBinding* binding, Config* config, long* traffic);
+long CountMissedAccesses(isl_union_map* accesses, isl_union_map* hits,
+	ParameterBinding* binding);
+MinMaxTuple* FindMinMaxTuple(vector<MinMaxTuple*> *minMaxTupleVector,
+	long min, long max);
+isl_union_pw_qpolynomial* ComputeFlopCount(Scop* scop);
+string PredictRoofline(long flops, long* traffic, SystemConfig* systemConfig,
+	double* gflops);
+void SimulateCachesForParameterValues(UserInput *userInput, Config *config,
+	Scop* scop);
+isl_union_pw_qpolynomial* ComputeReusePairs(isl_union_map* reusedAccesses);
+isl_stat AddArrayNameToAccesses(isl_map* accesses, void* user);
+void AddReuseDistances(map<string, map<int, double>>* histogram,
+	unordered_map<string, long>* reusePairs, long minBytes, long maxBytes);
+int ComputeReuseDistanceBucket(long bytes);
+void WriteReuseHistogramHeader(ostream& file, string prefixHeader);
+void WriteReuseHistogram(ostream& file, string rowPrefix,
+	map<string, map<int, double>>* histogram);
+int ComputeActiveSockets(SystemConfig* systemConfig, long numThreads);
+int ComputeSocketThreads(SystemConfig* systemConfig, long numThreads);
+long ComputeSocketWorkingSetSize(long size, int socketThreads, long numThreads,
+	bool isParallelLoopEncountered, long dataSetCommonCardInt);
+void ClearPolyScientistContext(PolyScientistContext* context);
+bool AreParameterValuesGiven(Scop* scop,
+	vector<unordered_map<string, int>>* paramValues);
 /* Function header declarations end */
 
-int main(int argc, char **argv) {
-	OrchestrateDataReuseComputation(argc, argv);
-	return 0;
-}
-
 void OrchestrateDataReuseComputation(int argc, char **argv) {
 	string fileName = "../apps/padded_conv_fp_stride_1_libxsmm_core2.c";
 
 	UserInput *userInput = new UserInput;
 	ReadUserInput(argc, argv, userInput);
 
+	if (userInput->profile) {
+		EnableProfiling();
+	}
+
 	Config *config = NULL;
 
 	if (!userInput->configFile.empty() ||
@@ -234,7 +612,12 @@ void OrchestrateDataReuseComputation(int argc, char **argv) {
 		}
 	}
 
-	ComputeDataReuseWorkingSets(userInput, config);
+	if (!userInput->inputList.empty()) {
+		ComputeDataReuseWorkingSetsForInputList(userInput, config);
+	}
+	else {
+		ComputeDataReuseWorkingSets(userInput, config);
+	}
 
 	if (!userInput->interactive) {
 		FreeConfig(config);
@@ -246,8 +629,41 @@ void OrchestrateDataReuseComputation(int argc, char **argv) {
 
 void ComputeDataReuseWorkingSets(UserInput *userInput, Config *config) {
 	isl_ctx* ctx = isl_ctx_alloc_with_pet_options();
-	pet_scop *scop = ParseScop(ctx, userInput->inputFile.c_str());
-	unordered_map<int, ArrayDataAccesses*>* dependenceMap = ComputeDataDependences(userInput, ctx, scop, config);
+	string snapshotDependencesKey;
+	vector<string> snapshotDependences;
+	Scop* scop = NULL;
+	if (!userInput->loadScop.empty()) {
+		scop = LoadScop(ctx, userInput, &snapshotDependencesKey,
+			&snapshotDependences);
+	}
+	else {
+		scop = ParseScop(ctx, userInput->inputFile.c_str());
+	}
+
+	if (scop == NULL) {
+		cout << "No scop found. Quitting" << endl;
+		exit(1);
+	}
+
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap = NULL;
+	if (!snapshotDependences.empty() && snapshotDependencesKey ==
+		GetDependencesCacheKey(userInput, scop, config)) {
+		cout << "Reading the dependences from the scop snapshot" << endl;
+		dependenceMap = DeserializeDependenceMap(ctx, &snapshotDependences);
+	}
+
+	if (dependenceMap == NULL) {
+		dependenceMap = ComputeDataDependences(userInput, ctx, scop, config);
+	}
+
+	if (!userInput->saveScop.empty()) {
+		vector<string> dependenceRecords;
+		SerializeDependenceMap(dependenceMap, &dependenceRecords);
+		if (!WriteScopSnapshot(userInput->saveScop, scop,
+			GetDependencesCacheKey(userInput, scop, config), &dependenceRecords)) {
+			exit(1);
+		}
+	}
 
 	if (dependenceMap->size() == 0) {
 		cout << "No depdendences found. Quitting" << endl;
@@ -262,7 +678,14 @@ void ComputeDataReuseWorkingSets(UserInput *userInput, Config *config) {
 		PrintWorkingSetSizes(workingSetSizes);
 	}
 
-	/*TODO: Deduplicate results*/
+	if (userInput->benchmarkEvaluator && config) {
+		BenchmarkPolynomialEvaluation(workingSetSizes, config, scop);
+	}
+
+	if (userInput->emitEvaluator && config) {
+		EmitWorkingSetEvaluator(workingSetSizes, userInput, config, scop);
+	}
+
 	if (userInput->interactive) {
 		SimplifyWorkingSetSizesInteractively(workingSetSizes,
 			userInput, config);
@@ -271,12 +694,238 @@ void ComputeDataReuseWorkingSets(UserInput *userInput, Config *config) {
 		SimplifyWorkingSetSizes(workingSetSizes, userInput, config, scop);
 	}
 
+	if (userInput->simulate && config) {
+		SimulateCachesForParameterValues(userInput, config, scop);
+	}
+
 	FreeWorkingSetSizes(workingSetSizes);
 	FreeDependenceMap(dependenceMap);
-	pet_scop_free(scop);
+	FreeScop(scop);
+	isl_ctx_free(ctx);
+
+	WriteProfile(userInput->inputFile + ExtractFileName(userInput->configFile)
+		+ "_profile.csv", userInput->inputFile);
+}
+
+void ComputeDataReuseWorkingSetsForInputList(UserInput *userInput,
+	Config *config) {
+	/* All the input files are analyzed in one process. Each worker thread owns
+	an isl_ctx that it reuses across the files it analyzes. The statistics of
+	all the files are written to one file in the order of the input list, each
+	row prefixed by the path of the input file as given in the list. The
+	files are also written side by side as the program variants of a
+	PolyRank input, one row per parameter configuration. */
+	vector<string>* inputFiles = new vector<string>();
+	ReadInputList(userInput->inputList, inputFiles);
+
+	InputFileQueue* queue = new InputFileQueue;
+	queue->inputFiles = inputFiles;
+	queue->stats = new vector<string>(inputFiles->size());
+	queue->arrayStats = new vector<string>(inputFiles->size());
+	queue->reuseHistograms = new vector<string>(inputFiles->size());
+	queue->polyRankGroups = new vector<vector<string>>(inputFiles->size());
+	queue->userInput = userInput;
+	queue->config = config;
+	queue->next = 0;
+
+	int numThreads = min(userInput->numJobs, (int)inputFiles->size());
+	vector<thread> threads;
+	for (int i = 0; i < numThreads; i++) {
+		threads.push_back(thread(ComputeDataReuseWorkingSetsWorker, queue));
+	}
+
+	for (int i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+
+	string inputList = userInput->inputList;
+	while (inputList.size() > 1 && inputList.back() == '/') {
+		inputList.pop_back();
+	}
+
+	string suffix = "_ws_stats.csv";
+	ofstream file;
+	string configFileName = ExtractFileName(userInput->configFile);
+	string fullFileName = inputList + configFileName + suffix;
+	file.open(fullFileName);
+
+	if (file.is_open()) {
+		cout << "Writing to file " << fullFileName << endl;
+	}
+	else {
+		cout << "Could not open the file: " << fullFileName << endl;
+		exit(1);
+	}
+
+	WriteWorkingSetSizesHeader(userInput, config, file, "input,");
+	for (int i = 0; i < queue->stats->size(); i++) {
+		file << queue->stats->at(i);
+	}
+
+	file.close();
+
+	if (userInput->arrayStats) {
+		string arrayFileName = inputList + configFileName + "_array_stats.csv";
+		file.open(arrayFileName);
+
+		if (file.is_open()) {
+			cout << "Writing to file " << arrayFileName << endl;
+		}
+		else {
+			cout << "Could not open the file: " << arrayFileName << endl;
+			exit(1);
+		}
+
+		WriteArrayStatsHeader(file, "input,");
+		for (int i = 0; i < queue->arrayStats->size(); i++) {
+			file << queue->arrayStats->at(i);
+		}
+
+		file.close();
+	}
+
+	if (userInput->reuseHistogram) {
+		string histogramFileName = inputList + configFileName
+			+ "_reuse_histogram.csv";
+		file.open(histogramFileName);
+
+		if (file.is_open()) {
+			cout << "Writing to file " << histogramFileName << endl;
+		}
+		else {
+			cout << "Could not open the file: " << histogramFileName << endl;
+			exit(1);
+		}
+
+		WriteReuseHistogramHeader(file, "input,");
+		for (int i = 0; i < queue->reuseHistograms->size(); i++) {
+			file << queue->reuseHistograms->at(i);
+		}
+
+		file.close();
+	}
+
+	WritePolyRankVariants(inputList + configFileName + "_polyrank.csv",
+		inputFiles, queue->polyRankGroups, config);
+
+	WriteProfile(inputList + configFileName + "_profile.csv", "");
+
+	delete queue->stats;
+	delete queue->arrayStats;
+	delete queue->reuseHistograms;
+	delete queue->polyRankGroups;
+	delete queue;
+	delete inputFiles;
+}
+
+void WritePolyRankVariants(string fileName, vector<string>* inputFiles,
+	vector<vector<string>>* polyRankGroups, Config *config) {
+	/* The layout is the one ReadProgramVariants() of scripts/PolyRank.cpp
+	parses: a configuration followed by a group of columns per variant. The
+	input files that were skipped are left out. */
+	ofstream file;
+	file.open(fileName);
+
+	if (file.is_open()) {
+		cout << "Writing to file " << fileName << endl;
+	}
+	else {
+		cout << "Could not open the file: " << fileName << endl;
+		exit(1);
+	}
+
+	file << "Config";
+	for (int i = 0; i < inputFiles->size(); i++) {
+		if (polyRankGroups->at(i).size() > 0) {
+			file << ",Version,GFLOPS,L1,L2,L3,Mem,L1DataSetSize,L2DataSetSize"
+				<< ",L3DataSetSize,MemDataSetSize,PessiL1DataSetSize"
+				<< ",PessiL2DataSetSize,PessiL3DataSetSize,PessiMemDataSetSize";
+		}
+	}
+
+	file << endl;
+
+	for (int j = 0; j < config->programParameterVector->size(); j++) {
+		file << GetParameterValuesString(config->programParameterVector->at(j));
+		for (int i = 0; i < inputFiles->size(); i++) {
+			if (polyRankGroups->at(i).size() > 0) {
+				file << "," << inputFiles->at(i) << ","
+					<< polyRankGroups->at(i)[j];
+			}
+		}
+
+		file << endl;
+	}
+
+	file.close();
+}
+
+void ComputeDataReuseWorkingSetsWorker(InputFileQueue* queue) {
+	/* The files are distributed across the workers. Therefore, the dependences
+	of a file are processed sequentially by its worker. */
+	UserInput userInput = *(queue->userInput);
+	userInput.numJobs = 1;
+
+	isl_ctx* ctx = isl_ctx_alloc_with_pet_options();
+	int numInputFiles = queue->inputFiles->size();
+	for (int i = queue->next++; i < numInputFiles; i = queue->next++) {
+		queue->stats->at(i) = ComputeDataReuseWorkingSetsForInputFile(ctx,
+			queue->inputFiles->at(i), &userInput, queue->config,
+			&queue->arrayStats->at(i), &queue->reuseHistograms->at(i),
+			&queue->polyRankGroups->at(i));
+	}
+
 	isl_ctx_free(ctx);
 }
 
+string ComputeDataReuseWorkingSetsForInputFile(isl_ctx* ctx, string inputFile,
+	UserInput *userInput, Config *config, string* arrayStats,
+	string* reuseHistograms, vector<string>* polyRankGroups) {
+	cout << "Analyzing " << inputFile << endl;
+	SetProfileInput(inputFile);
+
+	Scop* scop = NULL;
+	{
+		lock_guard<mutex> lock(parseScopMutex);
+		scop = ParseScop(ctx, inputFile.c_str());
+	}
+
+	if (scop == NULL) {
+		cout << "No scop found in " << inputFile << ". Skipping" << endl;
+		return "";
+	}
+
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap =
+		ComputeDataDependences(userInput, ctx, scop, config);
+
+	if (dependenceMap->size() == 0) {
+		cout << "No depdendences found in " << inputFile << ". Skipping" << endl;
+		FreeDependenceMap(dependenceMap);
+		FreeScop(scop);
+		return "";
+	}
+
+	vector<WorkingSetSize*>* workingSetSizes =
+		ComputeWorkingSetSizesForDependences(userInput,
+			dependenceMap, scop, config);
+
+	ostringstream stats;
+	ostringstream arrayStatsStream;
+	ostringstream histogramStream;
+	SimplifyWorkingSetSizes(workingSetSizes, userInput, config, scop, stats,
+		inputFile + ",",
+		userInput->arrayStats ? &arrayStatsStream : NULL,
+		userInput->reuseHistogram ? &histogramStream : NULL, polyRankGroups,
+		NULL);
+	*arrayStats = arrayStatsStream.str();
+	*reuseHistograms = histogramStream.str();
+
+	FreeWorkingSetSizes(workingSetSizes);
+	FreeDependenceMap(dependenceMap);
+	FreeScop(scop);
+	return stats.str();
+}
+
 void FreeDependenceMap(
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap) {
 
@@ -310,10 +959,11 @@ void RecognizeParallelIterationSpanningDependences(
 vector<WorkingSetSize*>* ComputeWorkingSetSizesForDependences(
 	UserInput *userInput,
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
-	pet_scop *scop, Config *config) {
-	/*TODO: The following code works for perfectly nested loops
-	only. It needs to be extended to cover data dependences that span
-	across loops*/
+	Scop* scop, Config *config) {
+	/* When the SCoP has more than one statement, the iterations executed
+	between the source and the target of a dependence are those of all the
+	statements, ordered by the schedule of the SCoP. This covers imperfectly
+	nested loops and dependences across loop nests. */
 
 	/* Here we assume that only may_dependences will be present because
 	ComputeDataDependences() function is specifying only may_read,
@@ -326,84 +976,364 @@ vector<WorkingSetSize*>* ComputeWorkingSetSizesForDependences(
 		}
 	}
 
+	isl_union_map* schedule = ComputePaddedScheduleMap(scop);
+
+	string cacheKey;
+	if (!userInput->cacheDir.empty() && dependenceMap->size() > 0) {
+		cacheKey = GetWorkingSetSizesCacheKey(dependenceMap, schedule, config);
+		vector<WorkingSetSize*>* cachedWorkingSetSizes =
+			ReadWorkingSetSizesFromCache(
+				isl_union_map_get_ctx(dependenceMap->begin()->second->dependences),
+				userInput->cacheDir, cacheKey);
+
+		if (cachedWorkingSetSizes) {
+			if (schedule) {
+				isl_union_map_free(schedule);
+			}
+
+			return cachedWorkingSetSizes;
+		}
+	}
+
 	vector<WorkingSetSize*>* workingSetSizes =
 		new vector<WorkingSetSize*>();
-	ArgComputeWorkingSetSizesForDependence* arg =
-		(ArgComputeWorkingSetSizesForDependence*)malloc(
-			sizeof(ArgComputeWorkingSetSizesForDependence));
-	arg->scop = scop;
-	arg->workingSetSizes = workingSetSizes;
-	arg->config = config;
 
-	for (auto i : *dependenceMap) {
-		arg->may_reads = i.second->may_reads;
-		arg->may_writes = i.second->may_writes;
-		isl_union_map_foreach_map(i.second->dependences,
-			&ComputeWorkingSetSizesForDependence, arg);
+	if (userInput->numJobs > 1) {
+		ComputeWorkingSetSizesForDependencesInParallel(userInput,
+			dependenceMap, schedule, config, workingSetSizes);
 	}
+	else {
+		ArgComputeWorkingSetSizesForDependence* arg =
+			(ArgComputeWorkingSetSizesForDependence*)malloc(
+				sizeof(ArgComputeWorkingSetSizesForDependence));
+		arg->scop = scop;
+		arg->workingSetSizes = workingSetSizes;
+		arg->schedule = schedule;
+		arg->config = config;
+		arg->deduplication = CreateDependenceDeduplication();
 
-	free(arg);
-	return workingSetSizes;
-}
+		for (auto i : *dependenceMap) {
+			/* The working sets depend on the accesses too. Therefore
+			dependences are deduplicated within an array only. */
+			ClearDependenceDeduplication(arg->deduplication);
+			arg->may_reads = i.second->may_reads;
+			arg->may_writes = i.second->may_writes;
+			isl_union_map_foreach_map(i.second->dependences,
+				&ComputeWorkingSetSizesForDependence, arg);
+		}
 
-isl_stat RecognizeParallelIterationSpanningDependenceMap(isl_map* dep, void *user) {
-	ParallelDependenceDetectionData *parallelDependenceDetectionData
-		= new ParallelDependenceDetectionData;
-	parallelDependenceDetectionData->parallelLoops = (vector<string>*)user;
+		if (!userInput->quiet) {
+			ReportDependenceDeduplication(arg->deduplication);
+		}
 
-	isl_map_foreach_basic_map(dep,
-		&RecognizeParallelIterationSpanningDependenceBasicMap,
-		parallelDependenceDetectionData);
+		FreeDependenceDeduplication(arg->deduplication);
+		free(arg);
+	}
 
-	delete parallelDependenceDetectionData;
-	return isl_stat_ok;
-}
+	if (!cacheKey.empty()) {
+		WriteWorkingSetSizesToCache(userInput->cacheDir, cacheKey,
+			workingSetSizes);
+	}
 
-isl_stat RecognizeParallelIterationSpanningDependenceBasicMap(
-	isl_basic_map* dep,
-	void *user) {
-	ParallelDependenceDetectionData *parallelDependenceDetectionData =
-		(ParallelDependenceDetectionData *)user;
-	vector<string> *parallelLoops = parallelDependenceDetectionData->parallelLoops;
-	parallelDependenceDetectionData->parallelDependence = false;
+	if (schedule) {
+		isl_union_map_free(schedule);
+	}
 
-	if (parallelLoops) {
-		if (DEBUG) {
-			for (int i = 0; i < parallelLoops->size(); i++) {
-				cout << parallelLoops->at(i) << " ";
-			}
+	return workingSetSizes;
+}
 
-			cout << endl;
-		}
+void ComputeWorkingSetSizesForDependencesInParallel(
+	UserInput *userInput,
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	isl_union_map* schedule,
+	Config *config, vector<WorkingSetSize*>* workingSetSizes) {
+	/* Every basic map of every dependence is a job. The jobs are collected in
+	the same order in which ComputeWorkingSetSizesForDependences() visits them
+	sequentially, and the results are merged back in that order. Therefore the
+	working sets, and the output files, are identical to the sequential run. */
+	WorkingSetSizeJobQueue* queue = new WorkingSetSizeJobQueue;
+	queue->jobs = new vector<WorkingSetSizeJob*>();
+	queue->may_reads = new unordered_map<int, string>();
+	queue->may_writes = new unordered_map<int, string>();
+	queue->schedule = schedule ? UnionMapToString(schedule) : "";
+	queue->config = config;
+	queue->next = 0;
+
+	ArgCollectWorkingSetSizeJobs* arg = new ArgCollectWorkingSetSizeJobs;
+	arg->jobs = queue->jobs;
+	arg->deduplication = CreateDependenceDeduplication();
 
-		for (int i = 0; i < parallelLoops->size(); i++) {
-			bool dependenceCrossing = IsDependenceProcessorCrossing(parallelLoops->at(i), dep);
+	for (auto i : *dependenceMap) {
+		queue->may_reads->insert({ i.first,
+			UnionMapToString(i.second->may_reads) });
+		queue->may_writes->insert({ i.first,
+			UnionMapToString(i.second->may_writes) });
 
-			if (DEBUG) {
-				cout << "In RecognizeParallelIterationSpanningDependenceBasicMap()" << endl;
-				PrintBasicMap(dep);
-				cout << "The dependence with respect to the parallel loop " << parallelLoops->at(i);
+		ClearDependenceDeduplication(arg->deduplication);
+		arg->arrayId = i.first;
+		isl_union_map_foreach_map(i.second->dependences,
+			&CollectWorkingSetSizeJobsForDependence, arg);
+	}
 
-				if (dependenceCrossing) {
-					cout << " IS_processor_crossing";
-				}
-				else {
-					cout << " is_NOT_processor_crossing";
-				}
+	if (!userInput->quiet) {
+		ReportDependenceDeduplication(arg->deduplication);
+	}
 
-				cout << endl;
-			}
+	FreeDependenceDeduplication(arg->deduplication);
+	delete arg;
 
-			if (dependenceCrossing) {
-				parallelDependenceDetectionData->parallelDependence = true;
-				parallelDependenceDetectionData->parallelLoop = parallelLoops->at(i);
-				break;
-			}
-		}
+	int numThreads = min(userInput->numJobs, (int)queue->jobs->size());
+	if (DEBUG) {
+		cout << "Number of working set size jobs: " << queue->jobs->size()
+			<< " Number of threads: " << numThreads << endl;
+	}
 
-		if (DEBUG) {
-			cout << "*********************" << endl;
-		}
+	vector<thread> threads;
+	for (int i = 0; i < numThreads; i++) {
+		threads.push_back(thread(ComputeWorkingSetSizesWorker, queue));
+	}
+
+	for (int i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+
+	for (int i = 0; i < queue->jobs->size(); i++) {
+		WorkingSetSizeJob* job = queue->jobs->at(i);
+		workingSetSizes->push_back(DeserializeWorkingSetSize(job->dependence,
+			job->result));
+		delete job->result;
+		delete job;
+	}
+
+	delete queue->jobs;
+	delete queue->may_reads;
+	delete queue->may_writes;
+	delete queue;
+}
+
+isl_stat CollectWorkingSetSizeJobsForDependence(isl_map* dep, void *user) {
+	isl_map_foreach_basic_map(dep,
+		&CollectWorkingSetSizeJobForDependenceBasicMap,
+		user);
+	return isl_stat_ok;
+}
+
+isl_stat CollectWorkingSetSizeJobForDependenceBasicMap(isl_basic_map* dep,
+	void *user) {
+	ArgCollectWorkingSetSizeJobs* arg = (ArgCollectWorkingSetSizeJobs*)user;
+	if (IsDuplicateDependence(arg->deduplication, dep)) {
+		isl_basic_map_free(dep);
+		return isl_stat_ok;
+	}
+
+	WorkingSetSizeJob* job = new WorkingSetSizeJob;
+	job->arrayId = arg->arrayId;
+	job->dependence = dep;
+	job->dependenceString = BasicMapToString(dep);
+	job->result = NULL;
+	arg->jobs->push_back(job);
+	return isl_stat_ok;
+}
+
+void ComputeWorkingSetSizesWorker(WorkingSetSizeJobQueue* queue) {
+	/* isl objects cannot be shared across threads. Each worker therefore
+	owns an isl_ctx and re-creates the accesses and dependences in it. */
+	isl_ctx* ctx = isl_ctx_alloc_with_pet_options();
+	unordered_map<int, isl_union_map*> may_reads;
+	unordered_map<int, isl_union_map*> may_writes;
+
+	for (auto i : *queue->may_reads) {
+		may_reads.insert({ i.first, UnionMapFromString(ctx, i.second) });
+	}
+
+	for (auto i : *queue->may_writes) {
+		may_writes.insert({ i.first, UnionMapFromString(ctx, i.second) });
+	}
+
+	vector<WorkingSetSize*>* workingSetSizes = new vector<WorkingSetSize*>();
+	ArgComputeWorkingSetSizesForDependence* arg =
+		(ArgComputeWorkingSetSizesForDependence*)malloc(
+			sizeof(ArgComputeWorkingSetSizesForDependence));
+	arg->scop = NULL;
+	arg->workingSetSizes = workingSetSizes;
+	arg->schedule = queue->schedule.empty() ? NULL :
+		UnionMapFromString(ctx, queue->schedule);
+	arg->config = queue->config;
+	arg->deduplication = NULL;
+
+	int numJobs = queue->jobs->size();
+	for (int i = queue->next++; i < numJobs; i = queue->next++) {
+		WorkingSetSizeJob* job = queue->jobs->at(i);
+		arg->may_reads = may_reads[job->arrayId];
+		arg->may_writes = may_writes[job->arrayId];
+
+		ComputeWorkingSetSizesForDependenceBasicMap(
+			BasicMapFromString(ctx, job->dependenceString), arg);
+
+		WorkingSetSize* workingSetSize = workingSetSizes->back();
+		workingSetSizes->pop_back();
+		job->result = SerializeWorkingSetSize(workingSetSize);
+		FreeWorkingSetSize(workingSetSize);
+	}
+
+	if (arg->schedule) {
+		isl_union_map_free(arg->schedule);
+	}
+
+	free(arg);
+	delete workingSetSizes;
+
+	for (auto i : may_reads) {
+		isl_union_map_free(i.second);
+	}
+
+	for (auto i : may_writes) {
+		isl_union_map_free(i.second);
+	}
+
+	isl_ctx_free(ctx);
+}
+
+SerializedWorkingSetSize* SerializeWorkingSetSize(WorkingSetSize* workingSetSize) {
+	SerializedWorkingSetSize* serializedWorkingSetSize = new SerializedWorkingSetSize;
+	serializedWorkingSetSize->dependence =
+		BasicMapToString(workingSetSize->dependence);
+	serializedWorkingSetSize->source = SetToString(workingSetSize->source);
+	serializedWorkingSetSize->target = SetToString(workingSetSize->target);
+	serializedWorkingSetSize->minTarget = SetToString(workingSetSize->minTarget);
+	serializedWorkingSetSize->maxTarget = SetToString(workingSetSize->maxTarget);
+	serializedWorkingSetSize->minSize =
+		UnionPwQpolynomialToString(workingSetSize->minSize);
+	serializedWorkingSetSize->maxSize =
+		UnionPwQpolynomialToString(workingSetSize->maxSize);
+	serializedWorkingSetSize->parallelLoop = workingSetSize->parallelLoop;
+	serializedWorkingSetSize->dataSetUnionSize =
+		UnionPwQpolynomialToString(workingSetSize->dataSetUnionSize);
+	serializedWorkingSetSize->dataSetCommonSize =
+		UnionPwQpolynomialToString(workingSetSize->dataSetCommonSize);
+	serializedWorkingSetSize->numParallelIters =
+		UnionPwQpolynomialToString(workingSetSize->numParallelIters);
+	serializedWorkingSetSize->parallelLoopIndex =
+		workingSetSize->parallelLoopIndex;
+	serializedWorkingSetSize->conflictSignature =
+		workingSetSize->conflictSignature ? *workingSetSize->conflictSignature : "";
+	serializedWorkingSetSize->indexCounts =
+		UnionPwQpolynomialToString(workingSetSize->indexCounts);
+	serializedWorkingSetSize->arraySizes =
+		UnionPwQpolynomialToString(workingSetSize->arraySizes);
+	serializedWorkingSetSize->approximate = workingSetSize->approximate;
+	serializedWorkingSetSize->reusedAccesses =
+		UnionMapToString(workingSetSize->reusedAccesses);
+	serializedWorkingSetSize->reusePairs =
+		UnionPwQpolynomialToString(workingSetSize->reusePairs);
+	return serializedWorkingSetSize;
+}
+
+WorkingSetSize* DeserializeWorkingSetSize(isl_basic_map* dependence,
+	SerializedWorkingSetSize* serializedWorkingSetSize) {
+	isl_ctx* ctx = isl_basic_map_get_ctx(dependence);
+	WorkingSetSize* workingSetSize =
+		(WorkingSetSize*)malloc(sizeof(WorkingSetSize));
+	workingSetSize->dependence = dependence;
+	workingSetSize->source = SetFromString(ctx, serializedWorkingSetSize->source);
+	workingSetSize->target = SetFromString(ctx, serializedWorkingSetSize->target);
+	workingSetSize->minTarget = SetFromString(ctx,
+		serializedWorkingSetSize->minTarget);
+	workingSetSize->maxTarget = SetFromString(ctx,
+		serializedWorkingSetSize->maxTarget);
+	workingSetSize->minSize = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->minSize);
+	workingSetSize->maxSize = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->maxSize);
+	workingSetSize->parallelLoop = serializedWorkingSetSize->parallelLoop;
+	workingSetSize->size = 0;
+	workingSetSize->dataSetUnionCardInt = 0;
+	workingSetSize->dataSetCommonCardInt = 0;
+	workingSetSize->dataSetUnionSize = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->dataSetUnionSize);
+	workingSetSize->dataSetCommonSize = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->dataSetCommonSize);
+	workingSetSize->numParallelIters = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->numParallelIters);
+	workingSetSize->parallelLoopIndex =
+		serializedWorkingSetSize->parallelLoopIndex;
+	workingSetSize->conflictSignature = NULL;
+	if (!serializedWorkingSetSize->conflictSignature.empty()) {
+		workingSetSize->conflictSignature =
+			new string(serializedWorkingSetSize->conflictSignature);
+	}
+
+	workingSetSize->indexCounts = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->indexCounts);
+	workingSetSize->arraySizes = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->arraySizes);
+	workingSetSize->approximate = serializedWorkingSetSize->approximate;
+	workingSetSize->reusedAccesses = UnionMapFromString(ctx,
+		serializedWorkingSetSize->reusedAccesses);
+	workingSetSize->reusePairs = UnionPwQpolynomialFromString(ctx,
+		serializedWorkingSetSize->reusePairs);
+
+	return workingSetSize;
+}
+
+isl_stat RecognizeParallelIterationSpanningDependenceMap(isl_map* dep, void *user) {
+	ParallelDependenceDetectionData *parallelDependenceDetectionData
+		= new ParallelDependenceDetectionData;
+	parallelDependenceDetectionData->parallelLoops = (vector<string>*)user;
+
+	isl_map_foreach_basic_map(dep,
+		&RecognizeParallelIterationSpanningDependenceBasicMap,
+		parallelDependenceDetectionData);
+
+	delete parallelDependenceDetectionData;
+	return isl_stat_ok;
+}
+
+isl_stat RecognizeParallelIterationSpanningDependenceBasicMap(
+	isl_basic_map* dep,
+	void *user) {
+	ParallelDependenceDetectionData *parallelDependenceDetectionData =
+		(ParallelDependenceDetectionData *)user;
+	vector<string> *parallelLoops = parallelDependenceDetectionData->parallelLoops;
+	parallelDependenceDetectionData->parallelDependence = false;
+
+	if (parallelLoops) {
+		if (DEBUG) {
+			for (int i = 0; i < parallelLoops->size(); i++) {
+				cout << parallelLoops->at(i) << " ";
+			}
+
+			cout << endl;
+		}
+
+		for (int i = 0; i < parallelLoops->size(); i++) {
+			bool dependenceCrossing = IsDependenceProcessorCrossing(parallelLoops->at(i), dep);
+
+			if (DEBUG) {
+				cout << "In RecognizeParallelIterationSpanningDependenceBasicMap()" << endl;
+				PrintBasicMap(dep);
+				cout << "The dependence with respect to the parallel loop " << parallelLoops->at(i);
+
+				if (dependenceCrossing) {
+					cout << " IS_processor_crossing";
+				}
+				else {
+					cout << " is_NOT_processor_crossing";
+				}
+
+				cout << endl;
+			}
+
+			if (dependenceCrossing) {
+				parallelDependenceDetectionData->parallelDependence = true;
+				parallelDependenceDetectionData->parallelLoop = parallelLoops->at(i);
+				break;
+			}
+		}
+
+		if (DEBUG) {
+			cout << "*********************" << endl;
+		}
 	}
 
 	return isl_stat_ok;
@@ -748,20 +1678,76 @@ DimPositions* FindPositionOfParallelLoop(string var,
 
 isl_stat ComputeWorkingSetSizesForDependence(isl_map* dep, void *user) {
 	isl_map_foreach_basic_map(dep,
-		&ComputeWorkingSetSizesForDependenceBasicMap,
+		&ComputeWorkingSetSizesForUniqueDependenceBasicMap,
 		user);
 	return isl_stat_ok;
 }
 
+isl_stat ComputeWorkingSetSizesForUniqueDependenceBasicMap(isl_basic_map* dep,
+	void *user) {
+	ArgComputeWorkingSetSizesForDependence* arg =
+		(ArgComputeWorkingSetSizesForDependence*)user;
+
+	if (IsDuplicateDependence(arg->deduplication, dep)) {
+		isl_basic_map_free(dep);
+		return isl_stat_ok;
+	}
+
+	return ComputeWorkingSetSizesForDependenceBasicMap(dep, user);
+}
+
 isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 	void *user) {
 	ArgComputeWorkingSetSizesForDependence* arg =
 		(ArgComputeWorkingSetSizesForDependence*)user;
-	pet_scop *scop = arg->scop;
+	Config* config = arg->config;
+
+	ProfileTimer* timer = NULL;
+	if (IsProfilingEnabled()) {
+		timer = StartProfileTimer("dependence", BasicMapToString(dep));
+	}
+
+	WorkingSetSize* workingSetSize = NULL;
+	if (IsDependenceBudgeted(config)) {
+		/* The isl operations of a dependence that exceeds its budget fail and
+		leave nothing to use. The dependence is then analyzed again, with its
+		data sets bounded by boxes instead of being counted. */
+		isl_ctx* ctx = isl_basic_map_get_ctx(dep);
+		AnalysisBudget* budget = StartAnalysisBudget(ctx,
+			config->dependenceTimeout, config->dependenceMaxOperations);
+		workingSetSize = ComputeWorkingSetSizeOfDependence(
+			isl_basic_map_copy(dep), arg);
+
+		if (StopAnalysisBudget(budget)) {
+			if (DEBUG) {
+				cout << "Budget exceeded. Bounding the data sets of: " << endl;
+				PrintBasicMap(dep);
+			}
+
+			FreeWorkingSetSize(workingSetSize);
+			boundDataSetCards = true;
+			workingSetSize = ComputeWorkingSetSizeOfDependence(
+				isl_basic_map_copy(dep), arg);
+			boundDataSetCards = false;
+			workingSetSize->approximate = true;
+		}
+
+		isl_basic_map_free(dep);
+	}
+	else {
+		workingSetSize = ComputeWorkingSetSizeOfDependence(dep, arg);
+	}
+
+	arg->workingSetSizes->push_back(workingSetSize);
+	StopProfileTimer(timer);
+	return isl_stat_ok;
+}
+
+WorkingSetSize* ComputeWorkingSetSizeOfDependence(isl_basic_map* dep,
+	ArgComputeWorkingSetSizesForDependence* arg) {
 	isl_union_map* may_reads = arg->may_reads;
 	isl_union_map* may_writes = arg->may_writes;
 	Config* config = arg->config;
-	vector<WorkingSetSize*>* workingSetSizes = arg->workingSetSizes;
 
 	ParallelDependenceDetectionData *parallelDependenceDetectionData
 		= new ParallelDependenceDetectionData;
@@ -770,6 +1756,36 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 	WorkingSetSize* workingSetSize =
 		(WorkingSetSize*)malloc(sizeof(WorkingSetSize));
 	workingSetSize->dependence = dep;
+	workingSetSize->conflictSignature = NULL;
+	workingSetSize->indexCounts = NULL;
+	workingSetSize->arraySizes = NULL;
+	workingSetSize->approximate = false;
+	workingSetSize->reusedAccesses = NULL;
+	if (config->modelTraffic) {
+		workingSetSize->reusedAccesses = ComputeReusedAccesses(dep, may_reads,
+			may_writes);
+	}
+
+	workingSetSize->reusePairs = NULL;
+	if (config->reportReuseDistances) {
+		workingSetSize->reusePairs = ComputeReusePairs(
+			workingSetSize->reusedAccesses ?
+			isl_union_map_copy(workingSetSize->reusedAccesses) :
+			ComputeReusedAccesses(dep, may_reads, may_writes));
+	}
+
+	DataSetFeatureRecorder dataSetFeatureRecorder;
+	dataSetFeatureRecorder.workingSetSize = workingSetSize;
+	dataSetFeatureRecorder.conflictSignature =
+		IsConflictModeled(config->systemConfig);
+	dataSetFeatureRecorder.indexCounts = config->modelTLB;
+	dataSetFeatureRecorder.arraySizes = config->reportArrays;
+	DataSetFeatureRecorder* recorder = NULL;
+	if (dataSetFeatureRecorder.conflictSignature ||
+		dataSetFeatureRecorder.indexCounts ||
+		dataSetFeatureRecorder.arraySizes) {
+		recorder = &dataSetFeatureRecorder;
+	}
 
 	if (parallelDependenceDetectionData->parallelDependence == false) {
 		if (DEBUG) {
@@ -797,17 +1813,29 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 			cout << "Computing minWSSize: " << endl;
 		}
 
-		isl_union_pw_qpolynomial* minWSSize =
-			ComputeDataSetSize(sourceDomain, source, minTarget, may_reads,
-				may_writes);
+		isl_union_pw_qpolynomial* minWSSize;
+		if (arg->schedule) {
+			minWSSize = ComputeScheduledDataSetSize(arg->schedule, source,
+				minTarget, may_reads, may_writes, NULL);
+		}
+		else {
+			minWSSize = ComputeDataSetSize(sourceDomain, source, minTarget,
+				may_reads, may_writes, NULL);
+		}
 
 		if (DEBUG) {
 			cout << "Computing maxWSSize: " << endl;
 		}
 
-		isl_union_pw_qpolynomial* maxWSSize =
-			ComputeDataSetSize(sourceDomain, source, maxTarget, may_reads,
-				may_writes);
+		isl_union_pw_qpolynomial* maxWSSize;
+		if (arg->schedule) {
+			maxWSSize = ComputeScheduledDataSetSize(arg->schedule, source,
+				maxTarget, may_reads, may_writes, recorder);
+		}
+		else {
+			maxWSSize = ComputeDataSetSize(sourceDomain, source, maxTarget,
+				may_reads, may_writes, recorder);
+		}
 
 		workingSetSize->source = source;
 		workingSetSize->target = target;
@@ -819,6 +1847,10 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 		workingSetSize->size = 0;
 		workingSetSize->dataSetUnionCardInt = 0;
 		workingSetSize->dataSetCommonCardInt = 0;
+		workingSetSize->dataSetUnionSize = NULL;
+		workingSetSize->dataSetCommonSize = NULL;
+		workingSetSize->numParallelIters = NULL;
+		workingSetSize->parallelLoopIndex = -1;
 		isl_basic_set_free(sourceDomain);
 	}
 	else {
@@ -832,8 +1864,16 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 		isl_basic_set* sourceDomain = isl_basic_map_domain(
 			isl_basic_map_copy(dep));
 
+		/* With nested parallel loops, the working set is the one of the
+		parallel loop whose iterations the dependence spans */
+		vector<string> spannedParallelLoop;
+		spannedParallelLoop.push_back(parallelDependenceDetectionData->parallelLoop);
 		int pos = FindThePositionOfTheLoopVariable(sourceDomain,
-			parallelDependenceDetectionData->parallelLoops);
+			&spannedParallelLoop);
+		workingSetSize->parallelLoopIndex = find(config->parallelLoops->begin(),
+			config->parallelLoops->end(),
+			parallelDependenceDetectionData->parallelLoop)
+			- config->parallelLoops->begin();
 
 		if (DEBUG) {
 			cout << "Data_dependence: " << endl;
@@ -844,33 +1884,33 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 		}
 
 		isl_set* sourceDomainLexmin = isl_basic_set_lexmin(isl_basic_set_copy(sourceDomain));
-		isl_basic_set* sourceDomainProjectedOuterLoopsProjected = ProjectBSetToLexExtreme(
+		isl_set* sourceDomainProjectedOuterLoopsProjected = ProjectBSetToLexExtreme(
 			sourceDomain,
 			sourceDomainLexmin, pos - 1);
 
-		isl_set* sourceDomainProjectedLexMin = isl_basic_set_lexmin(
-			isl_basic_set_copy(sourceDomainProjectedOuterLoopsProjected));
+		isl_set* sourceDomainProjectedLexMin = isl_set_lexmin(
+			isl_set_copy(sourceDomainProjectedOuterLoopsProjected));
 
-		isl_set* sourceDomainProjectedLexMax = isl_basic_set_lexmax(
-			isl_basic_set_copy(sourceDomainProjectedOuterLoopsProjected));
+		isl_set* sourceDomainProjectedLexMax = isl_set_lexmax(
+			isl_set_copy(sourceDomainProjectedOuterLoopsProjected));
 
-		isl_set* sourceDomainProjectedMin = isl_set_from_basic_set(
-			ProjectBSetToLexExtreme(
-				sourceDomain,
-				sourceDomainProjectedLexMin, pos));
-		isl_set* sourceDomainProjectedMax = isl_set_from_basic_set(
-			ProjectBSetToLexExtreme(
-				sourceDomain,
-				sourceDomainProjectedLexMax, pos));
+		isl_set* sourceDomainProjectedMin = ProjectBSetToLexExtreme(
+			sourceDomain,
+			sourceDomainProjectedLexMin, pos);
+		isl_set* sourceDomainProjectedMax = ProjectBSetToLexExtreme(
+			sourceDomain,
+			sourceDomainProjectedLexMax, pos);
+		isl_set_free(sourceDomainProjectedLexMin);
+		isl_set_free(sourceDomainProjectedLexMax);
 
 		ComputeWorkingSetSize(sourceDomainProjectedMin, sourceDomainProjectedMax,
-			may_reads, may_writes, config, sourceDomainProjectedOuterLoopsProjected,
-			pos, workingSetSize);
+			may_reads, may_writes, sourceDomainProjectedOuterLoopsProjected,
+			pos, workingSetSize, recorder);
 
 		isl_basic_set_free(sourceDomain);
 		isl_set_free(sourceDomainProjectedMin);
 		isl_set_free(sourceDomainProjectedMax);
-		isl_basic_set_free(sourceDomainProjectedOuterLoopsProjected);
+		isl_set_free(sourceDomainProjectedOuterLoopsProjected);
 
 		workingSetSize->source = sourceDomainLexmin;
 		workingSetSize->target = NULL;
@@ -882,27 +1922,30 @@ isl_stat ComputeWorkingSetSizesForDependenceBasicMap(isl_basic_map* dep,
 
 		if (DEBUG) {
 			cout << "In ComputeWorkingSetSize:" << endl;
-			cout << "workingSetSize->size: " << workingSetSize->size << endl;
-			cout << "workingSetSize->dataSetUnionCardInt: "
-				<< workingSetSize->dataSetUnionCardInt << endl;
-			cout << "workingSetSize->dataSetCommonCardInt: "
-				<< workingSetSize->dataSetCommonCardInt << endl;
+			cout << "workingSetSize->dataSetUnionSize: " << endl;
+			PrintUnionPwQpolynomial(workingSetSize->dataSetUnionSize);
+			cout << "workingSetSize->dataSetCommonSize: " << endl;
+			PrintUnionPwQpolynomial(workingSetSize->dataSetCommonSize);
+			cout << "workingSetSize->numParallelIters: " << endl;
+			PrintUnionPwQpolynomial(workingSetSize->numParallelIters);
 		}
 	}
 
 	delete parallelDependenceDetectionData;
-	workingSetSizes->push_back(workingSetSize);
-	return isl_stat_ok;
+	return workingSetSize;
 }
 
-isl_union_pw_qpolynomial* ComputeTotalDataSetSize(pet_scop *scop) {
-	isl_union_map *all_may_reads = pet_scop_get_may_reads(scop);
-	isl_union_map *all_may_writes = pet_scop_get_may_writes(scop);
+isl_union_pw_qpolynomial* ComputeTotalDataSetSize(Scop* scop,
+	Config *config) {
+	isl_union_map *all_may_reads = MapAccessesToDataUnits(
+		isl_union_map_copy(scop->mayReads), config);
+	isl_union_map *all_may_writes = MapAccessesToDataUnits(
+		isl_union_map_copy(scop->mayWrites), config);
 	isl_union_set* totalDataSet = NULL;
 
-	for (int i = 0; i < scop->n_stmt; i++) {
+	for (int i = 0; i < scop->statements->size(); i++) {
 		isl_union_set* domain = isl_union_set_from_set(
-			isl_set_copy(scop->stmts[i]->domain));
+			isl_set_copy(scop->statements->at(i).domain));
 		isl_union_set* readSet = isl_union_set_apply(isl_union_set_copy(domain),
 			isl_union_map_copy(all_may_reads));
 		isl_union_set* writeSet = isl_union_set_apply(isl_union_set_copy(domain),
@@ -919,27 +1962,27 @@ isl_union_pw_qpolynomial* ComputeTotalDataSetSize(pet_scop *scop) {
 		isl_union_set_free(domain);
 	}
 
-	return isl_union_set_card(totalDataSet);
+	return ComputeUnionSetCard(totalDataSet);
 }
 
-long ComputeNumberOfItersInParallelLoop(isl_basic_set* bset, int pos,
-	unordered_map<string, int>* paramValues) {
+isl_union_pw_qpolynomial* ComputeNumberOfItersInParallelLoop(
+	isl_set* set, int pos) {
 	// Project out the dimensions up to pos
-	isl_basic_set* bsetProjected = isl_basic_set_copy(bset);
-	isl_size dimSize = isl_basic_set_dim(bsetProjected, isl_dim_set);
+	isl_set* bsetProjected = isl_set_copy(set);
+	isl_size dimSize = isl_set_dim(bsetProjected, isl_dim_set);
 	if (DEBUG) {
 		cout << "pos: " << pos << " dimSize: " << dimSize << endl;
 		cout << "bsetProjectedBefore: " << endl;
-		PrintBasicSet(bsetProjected);
+		PrintSet(bsetProjected);
 	}
 
 	if (pos > 0) {
-		bsetProjected = isl_basic_set_project_out(bsetProjected, isl_dim_set, 0, pos);
+		bsetProjected = isl_set_project_out(bsetProjected, isl_dim_set, 0, pos);
 	}
 
 	if (DEBUG) {
 		cout << "bsetProjected after outer indexes are projected: " << endl;
-		PrintBasicSet(bsetProjected);
+		PrintSet(bsetProjected);
 	}
 
 	if (pos < (dimSize - 1)) {
@@ -950,43 +1993,25 @@ long ComputeNumberOfItersInParallelLoop(isl_basic_set* bset, int pos,
 
 		// Since the outer dimensions have been eliminated already, the index of the parallel
 		// dimension must be 0. Thus, starting index 1 must be other inner sequential loops.
-		bsetProjected = isl_basic_set_project_out(bsetProjected,
+		bsetProjected = isl_set_project_out(bsetProjected,
 			isl_dim_set, 1, numDimsToEliminate);
 	}
 
 	if (DEBUG) {
 		cout << "bsetProjected after inner indexes are projected: " << endl;
-		PrintBasicSet(bsetProjected);
-	}
-
-	isl_basic_set* bsetProjectedSimplified = SimplifyBasicSet(bsetProjected, paramValues);
-
-	if (DEBUG) {
-		cout << "bsetProjectedSimplified: " << endl;
-		PrintBasicSet(bsetProjectedSimplified);
+		PrintSet(bsetProjected);
 	}
 
-	isl_union_pw_qpolynomial* bsetProjectedSimplifiedCard =
-		isl_union_set_card(isl_union_set_from_basic_set(bsetProjectedSimplified));
-
-	long numIters = ExtractIntegerFromUnionPwQpolynomial(bsetProjectedSimplifiedCard);
-	isl_union_pw_qpolynomial_free(bsetProjectedSimplifiedCard);
-	isl_basic_set_free(bsetProjected);
-	return numIters;
+	return ComputeUnionSetCard(isl_union_set_from_set(bsetProjected));
 }
 
 void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 	isl_union_map* may_reads,
-	isl_union_map* may_writes, Config* config, isl_basic_set* domain, int pos,
-	WorkingSetSize* workingSetSize) {
-
-
-	if (config == NULL || config->programParameterVector == NULL ||
-		config->programParameterVector->size() != 1) {
-		cout << "The number of sets of parameters required is 1" << endl;
-		exit(1);
-	}
-
+	isl_union_map* may_writes, isl_set* domain, int pos,
+	WorkingSetSize* workingSetSize, DataSetFeatureRecorder* recorder) {
+	/* The data sets and the number of iterations of the parallel loop are
+	counted parametrically, once. The working set size is then evaluated for
+	every row of parameter values in EvaluateParallelWorkingSetSize(). */
 	isl_union_set* writeSetMin =
 		isl_union_set_apply(isl_union_set_from_set(isl_set_copy(min)),
 			isl_union_map_copy(may_writes));
@@ -995,9 +2020,7 @@ void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 		isl_union_set_apply(isl_union_set_from_set(isl_set_copy(min)),
 			isl_union_map_copy(may_reads));
 
-	isl_union_set* dataSetMinOrig = isl_union_set_union(writeSetMin, readSetMin);
-	isl_union_set* dataSetMin = SimplifyUnionSet(dataSetMinOrig, config->programParameterVector->at(0));
-	isl_union_pw_qpolynomial *dataSetMinCard = isl_union_set_card(isl_union_set_copy(dataSetMin));
+	isl_union_set* dataSetMin = isl_union_set_union(writeSetMin, readSetMin);
 
 	isl_union_set* writeSetMax =
 		isl_union_set_apply(isl_union_set_from_set(isl_set_copy(max)),
@@ -1007,46 +2030,40 @@ void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 		isl_union_set_apply(isl_union_set_from_set(isl_set_copy(max)),
 			isl_union_map_copy(may_reads));
 
-	isl_union_set* dataSetMaxOrig = isl_union_set_union(writeSetMax, readSetMax);
-	isl_union_set* dataSetMax = SimplifyUnionSet(dataSetMaxOrig, config->programParameterVector->at(0));
-	isl_union_pw_qpolynomial *dataSetMaxCard = isl_union_set_card(isl_union_set_copy(dataSetMax));
+	isl_union_set* dataSetMax = isl_union_set_union(writeSetMax, readSetMax);
 
 	isl_union_set* dataSetCommon = isl_union_set_intersect(isl_union_set_copy(dataSetMin),
 		isl_union_set_copy(dataSetMax));
-	isl_union_pw_qpolynomial *dataSetCommonCard = isl_union_set_card(isl_union_set_copy(dataSetCommon));
+	isl_union_pw_qpolynomial *dataSetCommonCard = ComputeDataSetCard(isl_union_set_copy(dataSetCommon));
 
 	isl_union_set* dataSetUnion = isl_union_set_union(isl_union_set_copy(dataSetMin),
 		isl_union_set_copy(dataSetMax));
-	isl_union_pw_qpolynomial *dataSetUnionCard = isl_union_set_card(isl_union_set_copy(dataSetUnion));
+	isl_union_pw_qpolynomial *dataSetUnionCard = ComputeDataSetCard(isl_union_set_copy(dataSetUnion));
 
 	// Compute the number of iterations
-	long numParallelIters = ComputeNumberOfItersInParallelLoop(domain, pos,
-		config->programParameterVector->at(0));
-	long dataSetUnionCardInt = ExtractIntegerFromUnionPwQpolynomial(dataSetUnionCard);
-	long dataSetCommonCardInt = ExtractIntegerFromUnionPwQpolynomial(dataSetCommonCard);
-
-	if (dataSetUnionCardInt < 0) {
-		dataSetUnionCardInt = 0;
-	}
-
-	if (dataSetCommonCardInt < 0) {
-		dataSetCommonCardInt = 0;
-	}
-
-	if (numParallelIters <= 0) {
-		cout << "numParallelIters is 0. Quitting" << endl;
-		exit(1);
+	isl_union_pw_qpolynomial* numParallelIters =
+		ComputeNumberOfItersInParallelLoop(domain, pos);
+
+	workingSetSize->size = 0;
+	workingSetSize->dataSetUnionCardInt = 0;
+	workingSetSize->dataSetCommonCardInt = 0;
+	workingSetSize->dataSetUnionSize = dataSetUnionCard;
+	workingSetSize->dataSetCommonSize = dataSetCommonCard;
+	workingSetSize->numParallelIters = numParallelIters;
+	if (recorder) {
+		/* The conflicts and the arrays are those of the data of the iterations
+		run together, while the pages are those of the one iteration run by a
+		thread */
+		DataSetFeatureRecorder unionRecorder = *recorder;
+		unionRecorder.indexCounts = false;
+		RecordDataSetFeatures(dataSetUnion, &unionRecorder);
+
+		DataSetFeatureRecorder minRecorder = *recorder;
+		minRecorder.conflictSignature = false;
+		minRecorder.arraySizes = false;
+		RecordDataSetFeatures(dataSetMin, &minRecorder);
 	}
 
-	// We divide numParallelIters because the dataSetUnionCardInt contains the number
-	// of data elements accessed in 2 iterations (NOT 1).
-	long WSSize = (dataSetUnionCardInt - dataSetCommonCardInt) * numParallelIters / 2.0
-		+ dataSetCommonCardInt;
-
-	workingSetSize->size = WSSize;
-	workingSetSize->dataSetUnionCardInt = dataSetUnionCardInt;
-	workingSetSize->dataSetCommonCardInt = dataSetCommonCardInt;
-
 	if (DEBUG) {
 		cout << "minIterationSet: " << endl;
 		PrintSet(min);
@@ -1056,16 +2073,12 @@ void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 
 		cout << "dataSetMin: " << endl;
 		PrintUnionSet(dataSetMin);
-		cout << "dataSetMinCard: " << endl;
-		PrintUnionPwQpolynomial(dataSetMinCard);
 
 		cout << "dataSetMax: " << endl;
 		PrintUnionSet(dataSetMax);
-		cout << "dataSetMaxCard: " << endl;
-		PrintUnionPwQpolynomial(dataSetMaxCard);
 
 		cout << "dataSetCommon: " << endl;
-		PrintUnionSet(dataSetMax);
+		PrintUnionSet(dataSetCommon);
 		cout << "dataSetCommonCard: " << endl;
 		PrintUnionPwQpolynomial(dataSetCommonCard);
 
@@ -1075,113 +2088,249 @@ void ComputeWorkingSetSize(isl_set*  min, isl_set* max,
 		PrintUnionPwQpolynomial(dataSetUnionCard);
 
 		cout << "Domain: " << endl;
-		PrintBasicSet(domain);
+		PrintSet(domain);
 
-		cout << "numParallelIters: " << numParallelIters << endl;
-		cout << "dataSetUnionCardInt: " << dataSetUnionCardInt << endl;
-		cout << "dataSetCommonCardInt: " << dataSetCommonCardInt << endl;
-		cout << "WSSize: " << WSSize << endl;
+		cout << "numParallelIters: " << endl;
+		PrintUnionPwQpolynomial(numParallelIters);
 	}
 
-	isl_union_set_free(dataSetMinOrig);
-	isl_union_set_free(dataSetMaxOrig);
 	isl_union_set_free(dataSetMin);
 	isl_union_set_free(dataSetMax);
 	isl_union_set_free(dataSetCommon);
 	isl_union_set_free(dataSetUnion);
-
-	isl_union_pw_qpolynomial_free(dataSetMinCard);
-	isl_union_pw_qpolynomial_free(dataSetMaxCard);
-	isl_union_pw_qpolynomial_free(dataSetCommonCard);
-	isl_union_pw_qpolynomial_free(dataSetUnionCard);
 }
 
+void EvaluateParallelWorkingSetSize(WorkingSetSize* workingSetSize,
+	ParameterBinding* binding, unordered_map<string, int>* paramValues,
+	vector<long>* parallelLoopThreads) {
+	long numParallelIters = EvaluateWorkingSetSize(
+		workingSetSize->numParallelIters, binding, paramValues);
+	long dataSetUnionCardInt = EvaluateWorkingSetSize(
+		workingSetSize->dataSetUnionSize, binding, paramValues);
+	long dataSetCommonCardInt = EvaluateWorkingSetSize(
+		workingSetSize->dataSetCommonSize, binding, paramValues);
 
-isl_basic_set* ProjectBSetToLexExtreme(isl_basic_set* sourceDomain,
-	isl_set* sourceDomainLexExtreme, int pos)
-{
-	isl_basic_set* sourceDomainProjected = isl_basic_set_copy(sourceDomain);
-	isl_basic_set_list *bsetList = isl_set_get_basic_set_list(sourceDomainLexExtreme);
-	isl_size basetListSize = isl_basic_set_list_size(bsetList);
-
-	if (DEBUG) {
-		cout << "sourceDomain:" << endl;
-		PrintBasicSet(sourceDomain);
+	if (dataSetUnionCardInt < 0) {
+		dataSetUnionCardInt = 0;
+	}
 
-		cout << "sourceDomainLexExtreme: " << endl;
-		PrintSet(sourceDomainLexExtreme);
+	if (dataSetCommonCardInt < 0) {
+		dataSetCommonCardInt = 0;
 	}
 
-	for (int k = 0; k < basetListSize; k++) {
-		isl_basic_set* bset = isl_basic_set_list_get_at(bsetList, k);
+	// A parallel loop of a single iteration, whose count is taken to be -1 as
+	// any size of 1, has no data reused across its iterations. As in the
+	// emitted evaluator, the dependence then has no working set.
+	if (numParallelIters <= 0) {
+		if (DEBUG) {
+			cout << "numParallelIters is 0 for the parameters "
+				<< GetParameterValuesString(paramValues) << endl;
+		}
 
-		isl_constraint_list *constraints =
-			isl_basic_set_get_constraint_list(bset);
-		isl_size constraintSize = isl_constraint_list_size(constraints);
+		workingSetSize->size = -1;
+		workingSetSize->dataSetUnionCardInt = dataSetUnionCardInt;
+		workingSetSize->dataSetCommonCardInt = dataSetCommonCardInt;
+		return;
+	}
 
-		for (int i = 0; i < constraintSize; i++) {
-			isl_constraint* constraint = isl_constraint_list_get_at(constraints, i);
+	// We divide numParallelIters because the dataSetUnionCardInt contains the number
+	// of data elements accessed in 2 iterations (NOT 1).
+	long WSSize = (dataSetUnionCardInt - dataSetCommonCardInt) * numParallelIters / 2.0
+		+ dataSetCommonCardInt;
 
-			for (int j = 0; j <= pos; j++) {
-				if (isl_constraint_involves_dims(constraint, isl_dim_set, j, 1)) {
-					if (DEBUG) {
-						cout << "Constraint that involves the outer loop dim: " << endl;
-						PrintConstraint(constraint);
-					}
+	// The threads that the parallel loops outer to the spanned parallel loop are
+	// split across run their own instances of the spanned loop at the same time.
+	// Each of the instances has its own working set.
+	long numInstances = 1;
+	for (int i = 0; i < workingSetSize->parallelLoopIndex; i++) {
+		numInstances *= parallelLoopThreads->at(i);
+	}
 
-					sourceDomainProjected = isl_basic_set_add_constraint(
-						sourceDomainProjected, isl_constraint_copy(constraint));
-				}
-			}
+	WSSize = WSSize * numInstances;
 
-			isl_constraint_free(constraint);
-		}
+	workingSetSize->size = WSSize;
+	workingSetSize->dataSetUnionCardInt = dataSetUnionCardInt;
+	workingSetSize->dataSetCommonCardInt = dataSetCommonCardInt;
 
-		isl_basic_set_free(bset);
+	if (DEBUG) {
+		cout << "numParallelIters: " << numParallelIters << endl;
+		cout << "dataSetUnionCardInt: " << dataSetUnionCardInt << endl;
+		cout << "dataSetCommonCardInt: " << dataSetCommonCardInt << endl;
+		cout << "numInstances: " << numInstances << endl;
+		cout << "WSSize: " << WSSize << endl;
 	}
+}
 
+vector<isl_union_pw_qpolynomial*>* ComputeParallelLoopTripCounts(
+	Scop* scop, Config* config) {
+	/* The trip counts are needed only to split the threads across nested
+	parallel loops whose numbers of threads are not given */
+	if (config->parallelLoops == NULL || config->parallelLoops->size() <= 1
+		|| config->parallelLoopThreads->at(0) > 0) {
+		return NULL;
+	}
 
-	if (DEBUG) {
-		cout << "sourceDomainProjected: " << endl;
-		PrintBasicSet(sourceDomainProjected);
+	vector<isl_union_pw_qpolynomial*>* tripCounts =
+		new vector<isl_union_pw_qpolynomial*>();
+	for (int i = 0; i < config->parallelLoops->size(); i++) {
+		tripCounts->push_back(ComputeParallelLoopTripCount(scop,
+			config->parallelLoops->at(i)));
 	}
 
-	return sourceDomainProjected;
+	return tripCounts;
 }
 
+isl_union_pw_qpolynomial* ComputeParallelLoopTripCount(Scop* scop,
+	string parallelLoop) {
+	/* The number of values the loop variable takes in the domain of the first
+	statement the loop encloses. NULL if no statement is enclosed by the loop. */
+	for (int i = 0; i < scop->statements->size(); i++) {
+		isl_set* domain = scop->statements->at(i).domain;
+		int pos = isl_set_find_dim_by_name(domain, isl_dim_set,
+			parallelLoop.c_str());
+
+		if (pos < 0) {
+			continue;
+		}
 
-int FindThePositionOfTheLoopVariable(isl_basic_set *bset,
-	vector<string> *parallelLoops) {
-	isl_size dimSize = isl_basic_set_dim(bset, isl_dim_set);
+		isl_size dimSize = isl_set_dim(domain, isl_dim_set);
+		isl_set* loopValues = isl_set_project_out(isl_set_copy(domain),
+			isl_dim_set, pos + 1, dimSize - pos - 1);
+		loopValues = isl_set_project_out(loopValues, isl_dim_set, 0, pos);
+		return ComputeUnionSetCard(isl_union_set_from_set(loopValues));
+	}
 
-	for (int j = 0; j < dimSize; j++) {
-		const char *name = isl_basic_set_get_dim_name(bset, isl_dim_set, j);
+	return NULL;
+}
 
-		vector<string>::iterator it;
-		string nameStr(name);
-		it = find(parallelLoops->begin(), parallelLoops->end(), nameStr);
+void FreeParallelLoopTripCounts(
+	vector<isl_union_pw_qpolynomial*>* tripCounts) {
+	if (tripCounts == NULL) {
+		return;
+	}
 
-		if (it != parallelLoops->end()) {
-			return j;
+	for (int i = 0; i < tripCounts->size(); i++) {
+		if (tripCounts->at(i)) {
+			isl_union_pw_qpolynomial_free(tripCounts->at(i));
 		}
 	}
 
-	return -1;
+	delete tripCounts;
 }
 
-isl_union_pw_qpolynomial* ComputeDataSetSize(isl_basic_set* sourceDomain,
-	isl_set* source, isl_set* target, isl_union_map* may_reads,
-	isl_union_map* may_writes) {
+long ComputeParallelLoopThreads(Config* config, int numProcs,
+	vector<isl_union_pw_qpolynomial*>* tripCounts, ParameterBinding* binding,
+	unordered_map<string, int>* paramValues, vector<long>* parallelLoopThreads) {
+	/* Computes the number of threads each parallel loop is split across and
+	returns the number of threads that have iterations to execute. Unless given
+	in the config, the threads are split as for a collapsed loop nest under a
+	static schedule: a loop takes as many threads as it has iterations, up to
+	the number of threads left, and the loops inside it split the threads that
+	share one of its iterations. */
+	parallelLoopThreads->clear();
+	if (config->parallelLoops == NULL) {
+		return numProcs;
+	}
 
-	/* itersUptoSourceExcludingSource := sourceDomain << source */
-	isl_union_set* itersUptoSourceExcludingSource =
-		isl_union_map_domain(
-			isl_union_set_lex_lt_union_set(
-				isl_union_set_from_basic_set(
-					isl_basic_set_copy(sourceDomain)),
-				isl_union_set_from_set(isl_set_copy(source))));
+	long numThreadsLeft = numProcs;
+	long numActiveThreads = 1;
+	for (int i = 0; i < config->parallelLoops->size(); i++) {
+		long numThreads = config->parallelLoopThreads->at(i);
+
+		if (numThreads == 0) {
+			numThreads = numThreadsLeft;
+			long tripCount = -1;
+			if (tripCounts && tripCounts->at(i) &&
+				!EvaluateUnionPwQpolynomial(tripCounts->at(i), binding, &tripCount)) {
+				tripCount = -1;
+			}
 
-	/* itersUptoTargetIncludingTarget := sourceDomain <<= target */
+			if (tripCount > 0) {
+				numThreads = min(numThreadsLeft, tripCount);
+			}
+
+			numThreadsLeft = (numThreadsLeft + numThreads - 1) / numThreads;
+		}
+
+		parallelLoopThreads->push_back(numThreads);
+		numActiveThreads *= numThreads;
+
+		if (DEBUG) {
+			cout << "Threads of the parallel loop " << config->parallelLoops->at(i)
+				<< ": " << numThreads << endl;
+		}
+	}
+
+	return min(numActiveThreads, (long)numProcs);
+}
+
+
+isl_set* ProjectBSetToLexExtreme(isl_basic_set* sourceDomain,
+	isl_set* sourceDomainLexExtreme, int pos)
+{
+	/* The points of the source domain whose dimensions up to pos are those of
+	the lexicographic extreme. The extreme of a parametric domain may have
+	several pieces, each for its own parameter values. A point is kept if it
+	agrees with any of them, so that the pieces are never combined into one. */
+	if (DEBUG) {
+		cout << "sourceDomain:" << endl;
+		PrintBasicSet(sourceDomain);
+
+		cout << "sourceDomainLexExtreme: " << endl;
+		PrintSet(sourceDomainLexExtreme);
+	}
+
+	isl_map* pointsToExtreme = isl_map_from_domain_and_range(
+		isl_set_from_basic_set(isl_basic_set_copy(sourceDomain)),
+		isl_set_copy(sourceDomainLexExtreme));
+	for (int j = 0; j <= pos; j++) {
+		pointsToExtreme = isl_map_equate(pointsToExtreme, isl_dim_in, j,
+			isl_dim_out, j);
+	}
+
+	isl_set* sourceDomainProjected = isl_map_domain(pointsToExtreme);
+
+	if (DEBUG) {
+		cout << "sourceDomainProjected: " << endl;
+		PrintSet(sourceDomainProjected);
+	}
+
+	return sourceDomainProjected;
+}
+
+
+int FindThePositionOfTheLoopVariable(isl_basic_set *bset,
+	vector<string> *parallelLoops) {
+	isl_size dimSize = isl_basic_set_dim(bset, isl_dim_set);
+
+	for (int j = 0; j < dimSize; j++) {
+		const char *name = isl_basic_set_get_dim_name(bset, isl_dim_set, j);
+
+		vector<string>::iterator it;
+		string nameStr(name);
+		it = find(parallelLoops->begin(), parallelLoops->end(), nameStr);
+
+		if (it != parallelLoops->end()) {
+			return j;
+		}
+	}
+
+	return -1;
+}
+
+isl_union_pw_qpolynomial* ComputeDataSetSize(isl_basic_set* sourceDomain,
+	isl_set* source, isl_set* target, isl_union_map* may_reads,
+	isl_union_map* may_writes, DataSetFeatureRecorder* recorder) {
+
+	/* itersUptoSourceExcludingSource := sourceDomain << source */
+	isl_union_set* itersUptoSourceExcludingSource =
+		isl_union_map_domain(
+			isl_union_set_lex_lt_union_set(
+				isl_union_set_from_basic_set(
+					isl_basic_set_copy(sourceDomain)),
+				isl_union_set_from_set(isl_set_copy(source))));
+
+	/* itersUptoTargetIncludingTarget := sourceDomain <<= target */
 	isl_union_set* itersUptoTargetIncludingTarget =
 		isl_union_map_domain(
 			isl_union_set_lex_le_union_set(
@@ -1197,13 +2346,107 @@ isl_union_pw_qpolynomial* ComputeDataSetSize(isl_basic_set* sourceDomain,
 			itersUptoSourceExcludingSource);
 
 	isl_union_pw_qpolynomial* WSSize = ComputeDataSetSize(
-		WS, may_reads, may_writes);
+		WS, may_reads, may_writes, recorder);
 	isl_union_set_free(WS);
 	return WSSize;
 }
 
+isl_union_pw_qpolynomial* ComputeScheduledDataSetSize(isl_union_map* schedule,
+	isl_set* source, isl_set* target, isl_union_map* may_reads,
+	isl_union_map* may_writes, DataSetFeatureRecorder* recorder) {
+	/* The same as ComputeDataSetSize() above, except that the iterations of
+	all the statements are considered and they are ordered by their schedule.
+	The source and the target may belong to different statements. */
+	isl_union_map* sourceSchedule = isl_union_map_intersect_domain(
+		isl_union_map_copy(schedule),
+		isl_union_set_from_set(isl_set_copy(source)));
+	isl_union_map* targetSchedule = isl_union_map_intersect_domain(
+		isl_union_map_copy(schedule),
+		isl_union_set_from_set(isl_set_copy(target)));
+
+	/* itersUptoSourceExcludingSource := schedule << schedule(source) */
+	isl_union_set* itersUptoSourceExcludingSource =
+		isl_union_map_domain(
+			isl_union_map_lex_lt_union_map(
+				isl_union_map_copy(schedule), sourceSchedule));
+
+	/* itersUptoTargetIncludingTarget := schedule <<= schedule(target) */
+	isl_union_set* itersUptoTargetIncludingTarget =
+		isl_union_map_domain(
+			isl_union_map_lex_le_union_map(
+				isl_union_map_copy(schedule), targetSchedule));
+
+	/* WS :=  itersUptoTargetIncludingTarget - itersUptoSourceExcludingSource */
+	isl_union_set* WS =
+		isl_union_set_subtract(
+			itersUptoTargetIncludingTarget,
+			itersUptoSourceExcludingSource);
+
+	isl_union_pw_qpolynomial* WSSize = ComputeDataSetSize(
+		WS, may_reads, may_writes, recorder);
+	isl_union_set_free(WS);
+	return WSSize;
+}
+
+isl_union_map* ComputePaddedScheduleMap(Scop* scop) {
+	/* The flattened schedule of a SCoP with more than one statement maps the
+	statements to schedule spaces of different dimensions, e.g., a statement
+	of an outer loop to fewer dimensions than that of an inner loop. The
+	schedule is padded with trailing zeros so that all the statement instances
+	can be compared lexicographically. A SCoP with one statement is ordered by
+	its iteration vectors and NULL is returned. */
+	if (scop->statements->size() <= 1) {
+		return NULL;
+	}
+
+	isl_schedule* schedule = isl_schedule_copy(scop->schedule);
+	isl_union_map* scheduleMap = isl_schedule_get_map(schedule);
+	isl_schedule_free(schedule);
+
+	SchedulePadding* padding = new SchedulePadding;
+	padding->numDims = 0;
+	isl_union_map_foreach_map(scheduleMap, &FindMaxScheduleDims, padding);
+
+	padding->paddedSchedule = isl_union_map_empty(
+		isl_union_map_get_space(scheduleMap));
+	isl_union_map_foreach_map(scheduleMap, &PadScheduleMap, padding);
+	isl_union_map_free(scheduleMap);
+
+	isl_union_map* paddedSchedule = padding->paddedSchedule;
+	delete padding;
+
+	if (DEBUG) {
+		cout << "Padded schedule: " << endl;
+		PrintUnionMap(paddedSchedule);
+	}
+
+	return paddedSchedule;
+}
+
+isl_stat FindMaxScheduleDims(isl_map* map, void* user) {
+	SchedulePadding* padding = (SchedulePadding*)user;
+	padding->numDims = max(padding->numDims,
+		(int)isl_map_dim(map, isl_dim_out));
+	isl_map_free(map);
+	return isl_stat_ok;
+}
+
+isl_stat PadScheduleMap(isl_map* map, void* user) {
+	SchedulePadding* padding = (SchedulePadding*)user;
+	int numDims = isl_map_dim(map, isl_dim_out);
+	map = isl_map_add_dims(map, isl_dim_out, padding->numDims - numDims);
+	for (int i = numDims; i < padding->numDims; i++) {
+		map = isl_map_fix_si(map, isl_dim_out, i, 0);
+	}
+
+	padding->paddedSchedule = isl_union_map_add_map(padding->paddedSchedule,
+		map);
+	return isl_stat_ok;
+}
+
 isl_union_pw_qpolynomial* ComputeDataSetSize(isl_union_set* WS,
-	isl_union_map *may_reads, isl_union_map *may_writes) {
+	isl_union_map *may_reads, isl_union_map *may_writes,
+	DataSetFeatureRecorder* recorder) {
 	isl_union_set* readSet =
 		isl_union_set_apply(isl_union_set_copy(WS),
 			isl_union_map_copy(may_reads));
@@ -1221,7 +2464,11 @@ isl_union_pw_qpolynomial* ComputeDataSetSize(isl_union_set* WS,
 	}
 
 	isl_union_set* dataSet = isl_union_set_union(readSet, writeSet);
-	return isl_union_set_card(dataSet);
+	if (recorder) {
+		RecordDataSetFeatures(dataSet, recorder);
+	}
+
+	return ComputeDataSetCard(dataSet);
 }
 
 string ExtractFileName(string fileName) {
@@ -1248,11 +2495,7 @@ bool compareByMinMaxSize(const MinMaxTuple* a, const MinMaxTuple* b) {
 }
 
 void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
-	UserInput *userInput, Config *config, pet_scop *scop) {
-
-	isl_union_pw_qpolynomial* totalDataSetSizeCard =
-		ComputeTotalDataSetSize(scop);
-
+	UserInput *userInput, Config *config, Scop* scop) {
 	string suffix = "_ws_stats.csv";
 	ofstream file;
 	string configFileName = ExtractFileName(userInput->configFile);
@@ -1268,42 +2511,177 @@ void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
 		exit(1);
 	}
 
+	ofstream arrayFile;
+	if (userInput->arrayStats) {
+		string arrayFileName = userInput->inputFile + configFileName
+			+ "_array_stats.csv";
+		arrayFile.open(arrayFileName);
+
+		if (arrayFile.is_open()) {
+			cout << "Writing to file " << arrayFileName << endl;
+		}
+		else {
+			cout << "Could not open the file: " << arrayFileName << endl;
+			exit(1);
+		}
+
+		WriteArrayStatsHeader(arrayFile, "");
+	}
+
+	ofstream histogramFile;
+	if (userInput->reuseHistogram) {
+		string histogramFileName = userInput->inputFile + configFileName
+			+ "_reuse_histogram.csv";
+		histogramFile.open(histogramFileName);
+
+		if (histogramFile.is_open()) {
+			cout << "Writing to file " << histogramFileName << endl;
+		}
+		else {
+			cout << "Could not open the file: " << histogramFileName << endl;
+			exit(1);
+		}
+
+		WriteReuseHistogramHeader(histogramFile, "");
+	}
+
+	WriteWorkingSetSizesHeader(userInput, config, file, "");
+	SimplifyWorkingSetSizes(workingSetSizes, userInput, config, scop, file, "",
+		userInput->arrayStats ? &arrayFile : NULL,
+		userInput->reuseHistogram ? &histogramFile : NULL, NULL, NULL);
+	file.close();
+
+	if (userInput->arrayStats) {
+		arrayFile.close();
+	}
+
+	if (userInput->reuseHistogram) {
+		histogramFile.close();
+	}
+}
+
+void WriteWorkingSetSizesHeader(UserInput *userInput, Config *config,
+	ostream& file,
+	string prefixHeader) {
+	if (userInput->minOutput == false) {
+		file << prefixHeader
+			<< "params,L1,L2,L3,Mem,L1DataSetSize,L2DataSetSize,L3DataSetSize,MemDataSetSize";
+		if (userInput->tlb) {
+			file << ",DTLBPages,STLBPages,WalkPages";
+		}
+
+		if (userInput->traffic || userInput->roofline) {
+			file << ",L2Reads,L2WriteAllocates,L2WriteBacks"
+				<< ",L3Reads,L3WriteAllocates,L3WriteBacks"
+				<< ",MemReads,MemWriteAllocates,MemWriteBacks";
+		}
+
+		if (config->systemConfig->numSockets > 1) {
+			file << ",Sockets,SocketThreads,SocketL3Fit,RemoteMemDataSetSize"
+				<< ",WeightedMemDataSetSize";
+			if (userInput->traffic || userInput->roofline) {
+				file << ",CrossSocketBytes";
+			}
+		}
+
+		if (userInput->roofline) {
+			file << ",Flops,PredictedGFLOPS,BindingLevel";
+		}
+
+		if (userInput->dependenceTimeout > 0 ||
+			userInput->dependenceMaxOperations > 0) {
+			file << ",Approximate";
+		}
+
+		file << endl;
+	}
+}
+
+void WriteArrayStatsHeader(ostream& file, string prefixHeader) {
+	file << prefixHeader
+		<< "params,array,L1,L2,L3,Mem,L1Reuses,L2Reuses,L3Reuses,MemReuses"
+		<< endl;
+}
+
+void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
+	UserInput *userInput, Config *config, Scop* scop, ostream& file,
+	string rowPrefix, ostream* arrayFile, ostream* histogramFile,
+	vector<string>* polyRankGroups, vector<DataSetSizes>* dataSetSizes) {
+
+	isl_union_pw_qpolynomial* totalDataSetSizeCard =
+		ComputeTotalDataSetSize(scop, config);
+
 	ProgramCharacteristics* programChar = new ProgramCharacteristics;
 	vector<MinMaxTuple*> *minMaxTupleVector = new vector<MinMaxTuple*>();
-	programChar->datatypeSize = config->datatypeSize;
+	programChar->datatypeSize = GetDataUnitSize(config);
+	vector<isl_union_pw_qpolynomial*>* parallelLoopTripCounts =
+		ComputeParallelLoopTripCounts(scop, config);
+	vector<long> parallelLoopThreads;
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents =
+		NULL;
+	if (IsConflictModeled(config->systemConfig) || config->modelTLB) {
+		arrayExtents = ComputeArrayExtents(scop);
+	}
 
-	if (userInput->minOutput == false) {
-		file << "params,L1,L2,L3,Mem,L1DataSetSize,L2DataSetSize,L3DataSetSize,MemDataSetSize" << endl;
+	unordered_map<string, vector<long>> arrayExtentValues;
+
+	isl_union_map* reads = NULL;
+	isl_union_map* writes = NULL;
+	if (config->modelTraffic) {
+		reads = MapAccessesToDataUnits(isl_union_map_copy(scop->mayReads),
+			config);
+		writes = MapAccessesToDataUnits(isl_union_map_copy(scop->mayWrites),
+			config);
+	}
+
+	isl_union_pw_qpolynomial* flopCount = NULL;
+	if (config->predictPerformance) {
+		flopCount = ComputeFlopCount(scop);
 	}
 
+	vector<MinMaxTuple*> workingSetTuples(workingSetSizes->size());
+
 	for (int j = 0; j < config->programParameterVector->size(); j++) {
 		InitializeProgramCharacteristics(programChar);
 		unordered_map<string, int>* paramValues =
 			config->programParameterVector->at(j);
 
-		string totalDataSetSizeCardString = SimplifyUnionPwQpolynomial(
-			totalDataSetSizeCard, paramValues);
-		long totalDataSetSize = -1;
+		ParameterBinding* binding = BindParameterValues(
+			isl_union_pw_qpolynomial_get_ctx(totalDataSetSizeCard), paramValues);
+
+		long totalDataSetSize = EvaluateWorkingSetSize(totalDataSetSizeCard,
+			binding, paramValues);
 
-		if (!totalDataSetSizeCardString.empty()) {
-			totalDataSetSize = ConvertStringToLong(totalDataSetSizeCardString)
-				* programChar->datatypeSize;
+		if (totalDataSetSize != -1) {
+			totalDataSetSize = totalDataSetSize * programChar->datatypeSize;
 		}
 
 		if (DEBUG) {
 			cout << "totalDataSetSize: " << totalDataSetSize << endl;
 		}
 
+		long numActiveThreads = ComputeParallelLoopThreads(config,
+			userInput->numProcs, parallelLoopTripCounts, binding, paramValues,
+			&parallelLoopThreads);
+
+		if (arrayExtents) {
+			EvaluateArrayExtents(arrayExtents, binding, &arrayExtentValues);
+		}
+
+		file << rowPrefix;
 		if (userInput->minOutput == false) {
 			file << GetParameterValuesString(paramValues) << ",";
 		}
 
 		bool doesParallelLoopExist = false;
+		bool isApproximate = false;
 		long dataSetUnionCardInt = -1;
 		long dataSetCommonCardInt = -1;
 
 		for (int i = 0; i < workingSetSizes->size(); i++) {
 			if (workingSetSizes->at(i)->parallelLoop == true) {
+				EvaluateParallelWorkingSetSize(workingSetSizes->at(i), binding,
+					paramValues, &parallelLoopThreads);
 				doesParallelLoopExist = true;
 				dataSetUnionCardInt = max(dataSetUnionCardInt,
 					workingSetSizes->at(i)->dataSetUnionCardInt
@@ -1320,27 +2698,21 @@ void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
 			cout << "dataSetCommonCardInt: " << dataSetCommonCardInt << endl;
 		}
 
+		map<string, map<int, double>> histogram;
 		for (int i = 0; i < workingSetSizes->size(); i++) {
 			long min = -1, max = -1;
 
 			bool isParallelLoopEncountered = false;
 
 			if (workingSetSizes->at(i)->parallelLoop == false) {
-				isl_union_pw_qpolynomial* minSizePoly =
-					workingSetSizes->at(i)->minSize;
-				string minSize = SimplifyUnionPwQpolynomial(
-					minSizePoly,
-					paramValues);
-
-				isl_union_pw_qpolynomial* maxSizePoly =
-					workingSetSizes->at(i)->maxSize;
-				string maxSize = SimplifyUnionPwQpolynomial(
-					maxSizePoly,
-					paramValues);
-
-				if (!minSize.empty() && !maxSize.empty()) {
-					min = ConvertStringToLong(minSize);
-					max = ConvertStringToLong(maxSize);
+				long minSize = EvaluateWorkingSetSize(
+					workingSetSizes->at(i)->minSize, binding, paramValues);
+				long maxSize = EvaluateWorkingSetSize(
+					workingSetSizes->at(i)->maxSize, binding, paramValues);
+
+				if (minSize != -1 && maxSize != -1) {
+					min = minSize;
+					max = maxSize;
 				}
 
 				if (DEBUG) {
@@ -1355,6 +2727,18 @@ void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
 				}
 			}
 
+			if (workingSetSizes->at(i)->approximate) {
+				isApproximate = true;
+			}
+
+			if (histogramFile && min != -1) {
+				unordered_map<string, long> reusePairs;
+				EvaluateArraySizes(workingSetSizes->at(i)->reusePairs, binding,
+					&reusePairs);
+				AddReuseDistances(&histogram, &reusePairs,
+					min * programChar->datatypeSize, max * programChar->datatypeSize);
+			}
+
 			MinMaxTuple* minMaxTuple = AddToVectorIfUniqueDependence(
 				minMaxTupleVector, min, max, isParallelLoopEncountered);
 
@@ -1367,17 +2751,34 @@ void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
 				}
 			}
 
+			if (minMaxTuple) {
+				minMaxTuple->workingSetSize = workingSetSizes->at(i);
+			}
+
+			workingSetTuples[i] = minMaxTuple ? minMaxTuple :
+				FindMinMaxTuple(minMaxTupleVector, min, max);
+
 			if (doesParallelLoopExist && minMaxTuple) {
 				minMaxTuple->dataSetUnionCardInt = dataSetUnionCardInt;
 				minMaxTuple->dataSetCommonCardInt = dataSetCommonCardInt;
 			}
+
+			if (IsConflictModeled(config->systemConfig) && minMaxTuple) {
+				ComputeConflictFactors(workingSetSizes->at(i)->conflictSignature,
+					&arrayExtentValues, config, minMaxTuple->conflictFactors);
+			}
 		}
 
 		sort(minMaxTupleVector->begin(), minMaxTupleVector->end(),
 			compareByMinMaxSize);
 
+		map<string, ArrayResidency> residencies;
 		bool isParallelLoopEncountered = false;
+		int socketL3Fit = 0;
 		for (int i = 0; i < minMaxTupleVector->size(); i++) {
+			long placedBytes[4] = { programChar->PessiL1DataSetSize,
+				programChar->PessiL2DataSetSize, programChar->PessiL3DataSetSize,
+				programChar->PessiMemDataSetSize };
 
 			if (isParallelLoopEncountered == false) {
 				isParallelLoopEncountered = minMaxTupleVector->at(i)->isParallelLoopEncountered;
@@ -1403,21 +2804,169 @@ void SimplifyWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes,
 				isParallelLoopEncountered,
 				doesParallelLoopExist,
 				config->systemConfig,
-				programChar, userInput->numProcs, totalDataSetSize,
-				dataSetUnionCardInt, dataSetCommonCardInt);
+				programChar, numActiveThreads, totalDataSetSize,
+				dataSetUnionCardInt, dataSetCommonCardInt,
+				minMaxTupleVector->at(i)->conflictFactors);
+
+			placedBytes[0] = programChar->PessiL1DataSetSize - placedBytes[0];
+			placedBytes[1] = programChar->PessiL2DataSetSize - placedBytes[1];
+			placedBytes[2] = programChar->PessiL3DataSetSize - placedBytes[2];
+			placedBytes[3] = programChar->PessiMemDataSetSize - placedBytes[3];
+			for (int level = 0; level < 4; level++) {
+				if (placedBytes[level] > 0) {
+					minMaxTupleVector->at(i)->level = level;
+				}
+			}
+
+			if (placedBytes[2] > 0) {
+				socketL3Fit += 1;
+			}
+
+			if (arrayFile) {
+				AddArrayResidencies(minMaxTupleVector->at(i), placedBytes, binding,
+					&residencies);
+			}
+		}
+
+		long traffic[9];
+		if (config->modelTraffic) {
+			ComputeTraffic(workingSetSizes, &workingSetTuples, reads, writes,
+				paramValues, binding, config, traffic);
+		}
+
+		long flops = -1;
+		double gflops = -1;
+		string bindingLevel;
+		if (flopCount) {
+			if (!EvaluateUnionPwQpolynomial(flopCount, binding, &flops)) {
+				flops = -1;
+			}
+
+			bindingLevel = PredictRoofline(flops, traffic, config->systemConfig,
+				&gflops);
+		}
+
+		long pages[3];
+		if (config->modelTLB) {
+			ComputeTLBFit(workingSetSizes, &arrayExtentValues, binding, config,
+				pages);
 		}
 
 		FreeMinMaxTupleVector(minMaxTupleVector);
+		FreeParameterBinding(binding);
+
+		if (dataSetSizes) {
+			DataSetSizes rowSizes;
+			rowSizes.paramValues = *paramValues;
+			rowSizes.L1 = programChar->PessiL1DataSetSize;
+			rowSizes.L2 = programChar->PessiL2DataSetSize;
+			rowSizes.L3 = programChar->PessiL3DataSetSize;
+			rowSizes.Mem = programChar->PessiMemDataSetSize;
+			rowSizes.approximate = isApproximate;
+			dataSetSizes->push_back(rowSizes);
+		}
 
 			file << programChar->PessiL1DataSetSize << ","
 			<< programChar->PessiL2DataSetSize << ","
 			<< programChar->PessiL3DataSetSize << ","
-			<< programChar->PessiMemDataSetSize
-			<< endl;
+			<< programChar->PessiMemDataSetSize;
+
+		if (config->modelTLB) {
+			file << "," << pages[0] << "," << pages[1] << "," << pages[2];
+		}
+
+		if (config->modelTraffic) {
+			for (int k = 0; k < 9; k++) {
+				file << "," << traffic[k];
+			}
+		}
+
+		if (config->systemConfig->numSockets > 1) {
+			/* The pages are taken to be spread evenly across the memories of the
+			sockets the threads run on, so that the other sockets hold all but
+			one share of the data of a socket */
+			int numSockets = ComputeActiveSockets(config->systemConfig,
+				numActiveThreads);
+			double remoteShare = (double)(numSockets - 1) / numSockets;
+			long remoteMemDataSetSize = llround(programChar->PessiMemDataSetSize
+				* remoteShare);
+			file << "," << numSockets << ","
+				<< ComputeSocketThreads(config->systemConfig, numActiveThreads)
+				<< "," << socketL3Fit << "," << remoteMemDataSetSize << ","
+				<< llround(programChar->PessiMemDataSetSize - remoteMemDataSetSize
+					+ remoteMemDataSetSize * config->systemConfig->remoteMemoryCost);
+
+			if (config->modelTraffic) {
+				long memBytes = traffic[6] + traffic[7] + traffic[8];
+				if (traffic[6] == -1 || traffic[7] == -1 || traffic[8] == -1) {
+					memBytes = -1;
+				}
+
+				file << "," << (memBytes == -1 ? -1 : llround(memBytes * remoteShare));
+			}
+		}
+
+		if (flopCount) {
+			file << "," << flops << "," << gflops << "," << bindingLevel;
+		}
+
+		if (polyRankGroups) {
+			/* The GFLOPS of a variant is the roofline prediction. Without
+			--roofline it is 0 and is to be replaced by the measured GFLOPS */
+			ostringstream group;
+			group << (flopCount ? max(gflops, 0.0) : 0.0) << ","
+				<< programChar->L1Fit << "," << programChar->L2Fit << ","
+				<< programChar->L3Fit << "," << programChar->MemFit << ","
+				<< programChar->L1DataSetSize << "," << programChar->L2DataSetSize
+				<< "," << programChar->L3DataSetSize << ","
+				<< programChar->MemDataSetSize << ","
+				<< programChar->PessiL1DataSetSize << ","
+				<< programChar->PessiL2DataSetSize << ","
+				<< programChar->PessiL3DataSetSize << ","
+				<< programChar->PessiMemDataSetSize;
+			polyRankGroups->push_back(group.str());
+		}
+
+		if (IsDependenceBudgeted(config)) {
+			file << "," << isApproximate;
+		}
+
+		file << endl;
+
+		if (arrayFile) {
+			for (auto k : residencies) {
+				*arrayFile << rowPrefix << GetParameterValuesString(paramValues)
+					<< "," << k.first;
+				for (int level = 0; level < 4; level++) {
+					*arrayFile << "," << llround(k.second.bytes[level]);
+				}
+
+				for (int level = 0; level < 4; level++) {
+					*arrayFile << "," << k.second.reuses[level];
+				}
+
+				*arrayFile << endl;
+			}
+		}
+
+		if (histogramFile) {
+			WriteReuseHistogram(*histogramFile,
+				rowPrefix + GetParameterValuesString(paramValues), &histogram);
+		}
 	}
 
-	file.close();
+	isl_union_pw_qpolynomial_free(totalDataSetSizeCard);
+	if (flopCount) {
+		isl_union_pw_qpolynomial_free(flopCount);
+	}
+
+	if (reads) {
+		isl_union_map_free(reads);
+		isl_union_map_free(writes);
+	}
 
+	FreeParallelLoopTripCounts(parallelLoopTripCounts);
+	FreeArrayExtents(arrayExtents);
 	delete minMaxTupleVector;
 	delete programChar;
 }
@@ -1436,6 +2985,13 @@ MinMaxTuple* AddToVectorIfUniqueDependence(vector<MinMaxTuple*> *minMaxTupleVect
 		minMaxTuple->min = min;
 		minMaxTuple->max = max;
 		minMaxTuple->isParallelLoopEncountered = isParallelLoopEncountered;
+		for (int i = 0; i < 3; i++) {
+			minMaxTuple->conflictFactors[i] = 1.0;
+		}
+
+		minMaxTuple->workingSetSize = NULL;
+		minMaxTuple->level = -1;
+
 		minMaxTupleVector->push_back(minMaxTuple);
 		return minMaxTuple;
 	}
@@ -1444,6 +3000,18 @@ MinMaxTuple* AddToVectorIfUniqueDependence(vector<MinMaxTuple*> *minMaxTupleVect
 	}
 }
 
+MinMaxTuple* FindMinMaxTuple(vector<MinMaxTuple*> *minMaxTupleVector,
+	long min, long max) {
+	for (int i = 0; i < minMaxTupleVector->size(); i++) {
+		if (minMaxTupleVector->at(i)->min == min &&
+			minMaxTupleVector->at(i)->max == max) {
+			return minMaxTupleVector->at(i);
+		}
+	}
+
+	return NULL;
+}
+
 void FreeMinMaxTupleVector(vector<MinMaxTuple*> *minMaxTupleVector) {
 	for (int i = 0; i < minMaxTupleVector->size(); i++) {
 		delete minMaxTupleVector->at(i);
@@ -1500,7 +3068,7 @@ void SimplifyWorkingSetSizesInteractively(vector<WorkingSetSize*>* workingSetSiz
 		GetSystemAndProgramCharacteristics(systemConfig, programChar);
 	}
 	else {
-		programChar->datatypeSize = config->datatypeSize;
+		programChar->datatypeSize = GetDataUnitSize(config);
 	}
 
 	char answer = 'Y';
@@ -1524,22 +3092,23 @@ void SimplifyWorkingSetSizesInteractively(vector<WorkingSetSize*>* workingSetSiz
 		file << "Parameters: " << GetParameterValuesString(paramValues)
 			<< endl;
 		file << "dependence \t source \t min_target \t max_target \t min_WS_size \t max_WS_size\n";
-		for (int i = 0; i < workingSetSizes->size(); i++) {
-			isl_union_pw_qpolynomial* minSizePoly =
-				workingSetSizes->at(i)->minSize;
-			string minSize = SimplifyUnionPwQpolynomial(
-				minSizePoly,
-				paramValues);
+		ParameterBinding* binding = NULL;
+		if (workingSetSizes->size() > 0) {
+			/* The sizes of a parallel working set are NULL. Every working set has
+			its dependence. */
+			binding = BindParameterValues(isl_basic_map_get_ctx(
+				workingSetSizes->at(0)->dependence), paramValues);
+		}
 
-			isl_union_pw_qpolynomial* maxSizePoly =
-				workingSetSizes->at(i)->maxSize;
-			string maxSize = SimplifyUnionPwQpolynomial(
-				maxSizePoly,
-				paramValues);
+		for (int i = 0; i < workingSetSizes->size(); i++) {
+			long min = EvaluateWorkingSetSize(
+				workingSetSizes->at(i)->minSize, binding, paramValues);
+			long max = EvaluateWorkingSetSize(
+				workingSetSizes->at(i)->maxSize, binding, paramValues);
 
-			if (!minSize.empty() && !maxSize.empty()) {
-				long min = ConvertStringToLong(minSize);
-				long max = ConvertStringToLong(maxSize);
+			if (min != -1 && max != -1) {
+				string minSize = to_string(min);
+				string maxSize = to_string(max);
 
 				if (AddToVectorIfUniqueDependence(minMaxTupleVector, min, max, false)) {
 					file << isl_basic_map_to_str(
@@ -1573,7 +3142,7 @@ void SimplifyWorkingSetSizesInteractively(vector<WorkingSetSize*>* workingSetSiz
 				minMaxTupleVector->at(i)->isParallelLoopEncountered,
 				false,
 				config->systemConfig,
-				programChar, 1, -1, -1, -1);
+				programChar, 1, -1, -1, -1, NULL);
 		}
 
 		file << "#reuses in L1, L2, L3:"
@@ -1593,6 +3162,10 @@ void SimplifyWorkingSetSizesInteractively(vector<WorkingSetSize*>* workingSetSiz
 			<< endl;
 
 		FreeMinMaxTupleVector(minMaxTupleVector);
+		if (binding) {
+			FreeParameterBinding(binding);
+		}
+
 
 		if (config == NULL) {
 			paramValues->clear();
@@ -1621,6 +3194,18 @@ void GetSystemAndProgramCharacteristics(SystemConfig* systemConfig,
 	cin >> systemConfig->L1;
 	cin >> systemConfig->L2;
 	cin >> systemConfig->L3;
+	systemConfig->L1Shared = false;
+	systemConfig->L2Shared = false;
+	systemConfig->L3Shared = false;
+	systemConfig->L1SharingDegree = 1;
+	systemConfig->L2SharingDegree = 1;
+	systemConfig->lineSize = 64;
+	systemConfig->L1Assoc = 0;
+	systemConfig->L2Assoc = 0;
+	systemConfig->L3Assoc = 0;
+	systemConfig->L1Sets = 0;
+	systemConfig->L2Sets = 0;
+	systemConfig->L3Sets = 0;
 
 	cout << "Enter the datatype size (in bytes): ";
 	cin >> programChar->datatypeSize;
@@ -1639,6 +3224,9 @@ void InitializeProgramCharacteristics(ProgramCharacteristics* programChar) {
 	programChar->PessiL2DataSetSize = 0;
 	programChar->PessiL3DataSetSize = 0;
 	programChar->PessiMemDataSetSize = 0;
+	programChar->PessiL1Occupancy = 0;
+	programChar->PessiL2Occupancy = 0;
+	programChar->PessiL3Occupancy = 0;
 }
 
 long ConvertStringToLong(string sizeStr) {
@@ -1684,76 +3272,87 @@ void UpdatePessimisticProgramCharacteristics(long minSize, long maxSize,
 	SystemConfig* systemConfig,
 	ProgramCharacteristics* programChar,
 	int numProcs, long totalDataSetSize,
-	long dataSetUnionCardInt, long dataSetCommonCardInt) {
+	long dataSetUnionCardInt, long dataSetCommonCardInt,
+	double* conflictFactors) {
 	minSize = minSize * programChar->datatypeSize;
 	maxSize = maxSize * programChar->datatypeSize;
 	bool maxSizeSatisfied = false;
 	bool minSizeSatisfied = false;
 
-
-	if (systemConfig->L1Shared || systemConfig->L2Shared) {
-		cout << "L1 and L2 caches are indicated as shared caches. Quitting." << endl;
-		exit(1);
-	}
-
+	// An L1 or an L2 cache shared by the hardware threads of a core holds the
+	// working sets of all the threads co-scheduled on the core. A cache cannot
+	// be shared by more threads than there are.
+	int L1Sharers = min(systemConfig->L1SharingDegree, numProcs);
+	int L2Sharers = min(systemConfig->L2SharingDegree, numProcs);
+	// Every socket has its own L3 cache, shared by the threads of the socket.
+	int L3Sharers = ComputeSocketThreads(systemConfig, numProcs);
+	long L3MaxSize = ComputeSocketWorkingSetSize(maxSize, L3Sharers, numProcs,
+		isParallelLoopEncountered, dataSetCommonCardInt);
+	long L3MinSize = ComputeSocketWorkingSetSize(minSize, L3Sharers, numProcs,
+		isParallelLoopEncountered, dataSetCommonCardInt);
 
 	if (minSize > 0 && maxSize > 0) {
-		if (!maxSizeSatisfied && ((maxSize + programChar->PessiL1DataSetSize) <= systemConfig->L1)) {
-			programChar->PessiL1DataSetSize += maxSize;
+		long L1MaxSize = ComputeSharedWorkingSetSize(maxSize, L1Sharers,
+			isParallelLoopEncountered, doesParallelLoopExist,
+			dataSetUnionCardInt, dataSetCommonCardInt);
+		long L1MinSize = ComputeSharedWorkingSetSize(minSize, L1Sharers,
+			isParallelLoopEncountered, doesParallelLoopExist,
+			dataSetUnionCardInt, dataSetCommonCardInt);
+		long L2MaxSize = ComputeSharedWorkingSetSize(maxSize, L2Sharers,
+			isParallelLoopEncountered, doesParallelLoopExist,
+			dataSetUnionCardInt, dataSetCommonCardInt);
+		long L2MinSize = ComputeSharedWorkingSetSize(minSize, L2Sharers,
+			isParallelLoopEncountered, doesParallelLoopExist,
+			dataSetUnionCardInt, dataSetCommonCardInt);
+
+		// A working set whose lines crowd into a few sets of a set-associative
+		// cache takes more of its capacity than its size.
+		long L1MaxOccupancy = ApplyConflictFactor(L1MaxSize, conflictFactors, 0);
+		long L1MinOccupancy = ApplyConflictFactor(L1MinSize, conflictFactors, 0);
+		long L2MaxOccupancy = ApplyConflictFactor(L2MaxSize, conflictFactors, 1);
+		long L2MinOccupancy = ApplyConflictFactor(L2MinSize, conflictFactors, 1);
+
+		if (!maxSizeSatisfied && ((L1MaxOccupancy + programChar->PessiL1Occupancy) <= systemConfig->L1)) {
+			programChar->PessiL1DataSetSize += L1MaxSize;
+			programChar->PessiL1Occupancy += L1MaxOccupancy;
 			minSizeSatisfied = true;
 			maxSizeSatisfied = true;
 		}
 
-		if (!minSizeSatisfied && ((minSize + programChar->PessiL1DataSetSize) <= systemConfig->L1)) {
-			programChar->PessiL1DataSetSize += minSize;
+		if (!minSizeSatisfied && ((L1MinOccupancy + programChar->PessiL1Occupancy) <= systemConfig->L1)) {
+			programChar->PessiL1DataSetSize += L1MinSize;
+			programChar->PessiL1Occupancy += L1MinOccupancy;
 			minSizeSatisfied = true;
 		}
 
-		if (!maxSizeSatisfied && ((maxSize + programChar->PessiL2DataSetSize) <= systemConfig->L2)) {
-			programChar->PessiL2DataSetSize += maxSize;
+		if (!maxSizeSatisfied && ((L2MaxOccupancy + programChar->PessiL2Occupancy) <= systemConfig->L2)) {
+			programChar->PessiL2DataSetSize += L2MaxSize;
+			programChar->PessiL2Occupancy += L2MaxOccupancy;
 			minSizeSatisfied = true;
 			maxSizeSatisfied = true;
 		}
 
-		if (!minSizeSatisfied && ((minSize + programChar->PessiL2DataSetSize) <= systemConfig->L2)) {
-			programChar->PessiL2DataSetSize += minSize;
+		if (!minSizeSatisfied && ((L2MinOccupancy + programChar->PessiL2Occupancy) <= systemConfig->L2)) {
+			programChar->PessiL2DataSetSize += L2MinSize;
+			programChar->PessiL2Occupancy += L2MinOccupancy;
 			minSizeSatisfied = true;
 		}
 
 		if (!maxSizeSatisfied) {
-			long effectiveMaxSize = maxSize;
-
-			if (SCALEDATASETSIZEATL3 && doesParallelLoopExist && !isParallelLoopEncountered
-				&& systemConfig->L3Shared) {
-
-				// We halve dataSetUnionCardInt because dataSetUnionCardInt is the union of 
-				// the datasets of two iterations. And therefore, halving it will give us the
-				// working set of one iteration.
-				// Here we are checking that effectiveMaxSize is greater than the working 
-				// set of one iteration of the parallel loop. If it is so, then the working set
-				// computation of the sequential loop should take into account the shared data
-				// between parallel iterations. We should subtract the shared data set size
-				// while multiplying the working set size of the sequential loop by the number
-				// of processors
-				if (effectiveMaxSize >= 0.5 * dataSetUnionCardInt) {
-					effectiveMaxSize = (effectiveMaxSize - dataSetCommonCardInt) * numProcs
-						+ dataSetCommonCardInt;
-				}
-				else {
-					double commonFraction = ((double)dataSetCommonCardInt) / ((double)dataSetUnionCardInt);
-
-					if (DEBUG) {
-						cout << "commonFraction: " << commonFraction << endl;
-					}
+			long effectiveMaxSize = L3MaxSize;
 
-					effectiveMaxSize = (1.0 - commonFraction) * effectiveMaxSize * numProcs
-						+ commonFraction * effectiveMaxSize;
-				}
+			if (SCALEDATASETSIZEATL3 && doesParallelLoopExist && systemConfig->L3Shared) {
+				effectiveMaxSize = ComputeSharedWorkingSetSize(maxSize, L3Sharers,
+					isParallelLoopEncountered, doesParallelLoopExist,
+					dataSetUnionCardInt, dataSetCommonCardInt);
 			}
 
 
-			if ((effectiveMaxSize + programChar->PessiL3DataSetSize) <= systemConfig->L3) {
+			long L3MaxOccupancy = ApplyConflictFactor(effectiveMaxSize,
+				conflictFactors, 2);
+			if ((L3MaxOccupancy + programChar->PessiL3Occupancy) <= systemConfig->L3) {
 				programChar->PessiL3DataSetSize += effectiveMaxSize;
+				programChar->PessiL3Occupancy += L3MaxOccupancy;
 				minSizeSatisfied = true;
 				maxSizeSatisfied = true;
 
@@ -1767,28 +3366,19 @@ void UpdatePessimisticProgramCharacteristics(long minSize, long maxSize,
 		}
 
 		if (!minSizeSatisfied) {
-			long effectiveMinSize = minSize;
-
-			if (SCALEDATASETSIZEATL3 && doesParallelLoopExist && !isParallelLoopEncountered
-				&& systemConfig->L3Shared) {
-				if (effectiveMinSize >= 0.5 * dataSetUnionCardInt) {
-					effectiveMinSize = (effectiveMinSize - dataSetCommonCardInt) * numProcs
-						+ dataSetCommonCardInt;
-				}
-				else {
-					double commonFraction = ((double)dataSetCommonCardInt) / ((double)dataSetUnionCardInt);
-
-					if (DEBUG) {
-						cout << "commonFraction: " << commonFraction << endl;
-					}
+			long effectiveMinSize = L3MinSize;
 
-					effectiveMinSize = (1.0 - commonFraction) * effectiveMinSize * numProcs
-						+ commonFraction * effectiveMinSize;
-				}
+			if (SCALEDATASETSIZEATL3 && doesParallelLoopExist && systemConfig->L3Shared) {
+				effectiveMinSize = ComputeSharedWorkingSetSize(minSize, L3Sharers,
+					isParallelLoopEncountered, doesParallelLoopExist,
+					dataSetUnionCardInt, dataSetCommonCardInt);
 			}
 
-			if ((effectiveMinSize + programChar->PessiL3DataSetSize) <= systemConfig->L3) {
+			long L3MinOccupancy = ApplyConflictFactor(effectiveMinSize,
+				conflictFactors, 2);
+			if ((L3MinOccupancy + programChar->PessiL3Occupancy) <= systemConfig->L3) {
 				programChar->PessiL3DataSetSize += effectiveMinSize;
+				programChar->PessiL3Occupancy += L3MinOccupancy;
 				minSizeSatisfied = true;
 
 				if (DEBUG) {
@@ -1804,20 +3394,9 @@ void UpdatePessimisticProgramCharacteristics(long minSize, long maxSize,
 			long effectiveMaxSize = maxSize;
 
 			if (SCALEDATASETSIZEATL3 && doesParallelLoopExist && !isParallelLoopEncountered) {
-				if (effectiveMaxSize >= 0.5 * dataSetUnionCardInt) {
-					effectiveMaxSize = (effectiveMaxSize - dataSetCommonCardInt) * numProcs
-						+ dataSetCommonCardInt;
-				}
-				else {
-					double commonFraction = ((double)dataSetCommonCardInt) / ((double)dataSetUnionCardInt);
-
-					if (DEBUG) {
-						cout << "commonFraction: " << commonFraction << endl;
-					}
-
-					effectiveMaxSize = (1.0 - commonFraction) * effectiveMaxSize * numProcs
-						+ commonFraction * effectiveMaxSize;
-				}
+				effectiveMaxSize = ComputeSharedWorkingSetSize(maxSize, numProcs,
+					isParallelLoopEncountered, doesParallelLoopExist,
+					dataSetUnionCardInt, dataSetCommonCardInt);
 
 				if (DEBUG) {
 					cout << "Mem adjustment made:" << endl;
@@ -1846,6 +3425,44 @@ void UpdatePessimisticProgramCharacteristics(long minSize, long maxSize,
 	}
 }
 
+long ComputeSharedWorkingSetSize(long size, int numSharers,
+	bool isParallelLoopEncountered, bool doesParallelLoopExist,
+	long dataSetUnionCardInt, long dataSetCommonCardInt) {
+	/* The combined size of the working sets of numSharers threads that run
+	iterations of the parallel loop at the same time. The working set of a
+	dependence that spans the iterations of the parallel loop is already the
+	combined one. Without a parallel loop, nothing is known to be shared between
+	the threads. */
+	if (numSharers <= 1 || isParallelLoopEncountered) {
+		return size;
+	}
+
+	if (!doesParallelLoopExist) {
+		return size * numSharers;
+	}
+
+	// We halve dataSetUnionCardInt because dataSetUnionCardInt is the union of 
+	// the datasets of two iterations. And therefore, halving it will give us the
+	// working set of one iteration.
+	// Here we are checking that size is greater than the working set of one
+	// iteration of the parallel loop. If it is so, then the working set
+	// computation of the sequential loop should take into account the shared data
+	// between parallel iterations. We should subtract the shared data set size
+	// while multiplying the working set size of the sequential loop by the number
+	// of processors
+	if (size >= 0.5 * dataSetUnionCardInt) {
+		return (size - dataSetCommonCardInt) * numSharers + dataSetCommonCardInt;
+	}
+
+	double commonFraction = ((double)dataSetCommonCardInt) / ((double)dataSetUnionCardInt);
+
+	if (DEBUG) {
+		cout << "commonFraction: " << commonFraction << endl;
+	}
+
+	return (1.0 - commonFraction) * size * numSharers + commonFraction * size;
+}
+
 unordered_map<string, int>* GetParameterValues(vector<WorkingSetSize*>* workingSetSizes) {
 	unordered_map<string, int>* paramValues =
 		new unordered_map<string, int>();
@@ -1958,12 +3575,14 @@ isl_basic_set* SimplifyBasicSet(isl_basic_set* bset,
 
 string SimplifyUnionPwQpolynomial(isl_union_pw_qpolynomial* size,
 	unordered_map<string, int>* paramValues) {
+	ProfileTimer* timer = StartProfileTimer("gist_params");
 	isl_set* context = ConstructContextEquatingParametersToConstants(
 		isl_union_pw_qpolynomial_get_space(size), paramValues);
 	isl_union_pw_qpolynomial* gistSize =
 		isl_union_pw_qpolynomial_gist_params(
 			isl_union_pw_qpolynomial_copy(size),
 			context);
+	StopProfileTimer(timer);
 
 	long sizeInteger = ExtractIntegerFromUnionPwQpolynomial(gistSize);
 	if (DEBUG) {
@@ -1978,6 +3597,158 @@ string SimplifyUnionPwQpolynomial(isl_union_pw_qpolynomial* size,
 	return sizeString;
 }
 
+long EvaluateWorkingSetSize(isl_union_pw_qpolynomial* size,
+	ParameterBinding* binding, unordered_map<string, int>* paramValues) {
+	/* The polynomial is evaluated numerically at the bound parameter values.
+	Only if that is not possible, the polynomial is simplified with respect to
+	the parameter values and the value is extracted from its string form. */
+	long val = -1;
+	ProfileTimer* timer = StartProfileTimer("evaluate");
+	bool isEvaluated = EvaluateUnionPwQpolynomial(size, binding, &val);
+	StopProfileTimer(timer);
+
+	if (isEvaluated) {
+		if (IGNORE_WS_SIZE_ONE && val == 1) {
+			val = -1;
+		}
+
+		if (DEBUG) {
+			cout << "evaluatedSize: " << val << endl;
+		}
+
+		return val;
+	}
+
+	string sizeString = SimplifyUnionPwQpolynomial(size, paramValues);
+	if (!sizeString.empty()) {
+		val = ConvertStringToLong(sizeString);
+	}
+
+	return val;
+}
+
+void EmitWorkingSetEvaluator(vector<WorkingSetSize*>* workingSetSizes,
+	UserInput *userInput, Config *config, Scop* scop) {
+	vector<EvaluatorWorkingSet*> workingSets;
+	for (int i = 0; i < workingSetSizes->size(); i++) {
+		EvaluatorWorkingSet* workingSet = new EvaluatorWorkingSet;
+		workingSet->minSize = workingSetSizes->at(i)->minSize;
+		workingSet->maxSize = workingSetSizes->at(i)->maxSize;
+		workingSet->parallelLoop = workingSetSizes->at(i)->parallelLoop;
+		workingSet->dataSetUnionSize = workingSetSizes->at(i)->dataSetUnionSize;
+		workingSet->dataSetCommonSize =
+			workingSetSizes->at(i)->dataSetCommonSize;
+		workingSet->numParallelIters = workingSetSizes->at(i)->numParallelIters;
+		workingSet->parallelLoopIndex = workingSetSizes->at(i)->parallelLoopIndex;
+		workingSets.push_back(workingSet);
+	}
+
+	isl_union_pw_qpolynomial* totalDataSetSizeCard =
+		ComputeTotalDataSetSize(scop, config);
+
+	EvaluatorParallelLoops parallelLoops;
+	parallelLoops.threads = config->parallelLoopThreads;
+	parallelLoops.tripCounts = ComputeParallelLoopTripCounts(scop, config);
+	parallelLoops.numProcs = userInput->numProcs;
+
+	if (IsConflictModeled(config->systemConfig)) {
+		cout << "The emitted evaluator does not model the conflicts in "
+			<< "set-associative caches" << endl;
+	}
+
+	/* Named like the statistics, which a scan of the .c files of a directory
+	by --input-list skips */
+	EmitEvaluator(userInput->inputFile + ExtractFileName(userInput->configFile)
+		+ "_evaluator.c", userInput->inputFile,
+		&workingSets, totalDataSetSizeCard, &parallelLoops, config->systemConfig,
+		GetDataUnitSize(config), IGNORE_WS_SIZE_ONE);
+
+	isl_union_pw_qpolynomial_free(totalDataSetSizeCard);
+	FreeParallelLoopTripCounts(parallelLoops.tripCounts);
+	for (int i = 0; i < workingSets.size(); i++) {
+		delete workingSets[i];
+	}
+}
+
+void BenchmarkPolynomialEvaluation(vector<WorkingSetSize*>* workingSetSizes,
+	Config *config, Scop* scop) {
+	/* Evaluates all the working set polynomials at all the parameter rows of
+	the config file, once by gisting and scraping the strings and once
+	numerically, and reports the time taken by each and the number of values
+	on which the two disagree. A disagreement where the old path yields no value
+	(-1) is not counted, as the old path does not handle piecewise results. */
+	vector<isl_union_pw_qpolynomial*> polynomials;
+	isl_union_pw_qpolynomial* totalDataSetSizeCard =
+		ComputeTotalDataSetSize(scop, config);
+	polynomials.push_back(totalDataSetSizeCard);
+
+	for (int i = 0; i < workingSetSizes->size(); i++) {
+		if (workingSetSizes->at(i)->parallelLoop == false) {
+			polynomials.push_back(workingSetSizes->at(i)->minSize);
+			polynomials.push_back(workingSetSizes->at(i)->maxSize);
+		}
+	}
+
+	int numRows = config->programParameterVector->size();
+	vector<long> oldValues, newValues;
+
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	for (int j = 0; j < numRows; j++) {
+		unordered_map<string, int>* paramValues =
+			config->programParameterVector->at(j);
+		for (int i = 0; i < polynomials.size(); i++) {
+			string sizeString = SimplifyUnionPwQpolynomial(polynomials[i],
+				paramValues);
+			oldValues.push_back(sizeString.empty() ? -1 :
+				ConvertStringToLong(sizeString));
+		}
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	double oldTime = chrono::duration<double>(end - begin).count();
+
+	begin = chrono::steady_clock::now();
+	for (int j = 0; j < numRows; j++) {
+		unordered_map<string, int>* paramValues =
+			config->programParameterVector->at(j);
+		ParameterBinding* binding = BindParameterValues(
+			isl_union_pw_qpolynomial_get_ctx(totalDataSetSizeCard), paramValues);
+		for (int i = 0; i < polynomials.size(); i++) {
+			newValues.push_back(EvaluateWorkingSetSize(polynomials[i], binding,
+				paramValues));
+		}
+
+		FreeParameterBinding(binding);
+	}
+	end = chrono::steady_clock::now();
+	double newTime = chrono::duration<double>(end - begin).count();
+
+	int numMismatches = 0, numRecovered = 0;
+	for (int i = 0; i < oldValues.size(); i++) {
+		if (oldValues[i] == -1 && newValues[i] != -1) {
+			numRecovered++;
+		}
+		else if (oldValues[i] != newValues[i]) {
+			numMismatches++;
+			if (DEBUG) {
+				cout << "Mismatch at " << i << ": " << oldValues[i] << " "
+					<< newValues[i] << endl;
+			}
+		}
+	}
+
+	cout << "Evaluated " << polynomials.size() << " polynomials at "
+		<< numRows << " parameter rows" << endl;
+	cout << "String-based evaluation: " << oldTime << " s" << endl;
+	cout << "Numeric evaluation: " << newTime << " s" << endl;
+	if (newTime > 0) {
+		cout << "Speedup: " << oldTime / newTime << endl;
+	}
+	cout << "Values only the numeric evaluation yields: " << numRecovered << endl;
+	cout << "Mismatches: " << numMismatches << endl;
+
+	isl_union_pw_qpolynomial_free(totalDataSetSizeCard);
+}
+
 long ExtractIntegerFromUnionPwQpolynomial(
 	isl_union_pw_qpolynomial* polynomial)
 {
@@ -2064,6 +3835,7 @@ void PrintWorkingSetSize(WorkingSetSize* wss) {
 	PrintUnionPwQpolynomial(wss->maxSize);
 
 	cout << "parallelLoop: " << wss->parallelLoop << endl;
+	cout << "parallelLoopIndex: " << wss->parallelLoopIndex << endl;
 	cout << "size: " << wss->size << endl;
 }
 
@@ -2087,40 +3859,71 @@ void FreeWorkingSetSizes(vector<WorkingSetSize*>* workingSetSizes) {
 			continue;
 		}
 
-		if (workingSetSizes->at(i)->dependence) {
-			isl_basic_map_free(workingSetSizes->at(i)->dependence);
-		}
+		FreeWorkingSetSize(workingSetSizes->at(i));
+	}
 
-		if (workingSetSizes->at(i)->source) {
-			isl_set_free(workingSetSizes->at(i)->source);
-		}
+	delete workingSetSizes;
+}
 
-		if (workingSetSizes->at(i)->target) {
-			isl_set_free(workingSetSizes->at(i)->target);
-		}
+void FreeWorkingSetSize(WorkingSetSize* workingSetSize) {
+	if (workingSetSize->dependence) {
+		isl_basic_map_free(workingSetSize->dependence);
+	}
 
-		if (workingSetSizes->at(i)->minTarget) {
-			isl_set_free(workingSetSizes->at(i)->minTarget);
-		}
+	if (workingSetSize->source) {
+		isl_set_free(workingSetSize->source);
+	}
 
-		if (workingSetSizes->at(i)->maxTarget) {
-			isl_set_free(workingSetSizes->at(i)->maxTarget);
-		}
+	if (workingSetSize->target) {
+		isl_set_free(workingSetSize->target);
+	}
 
-		if (workingSetSizes->at(i)->minSize) {
-			isl_union_pw_qpolynomial_free(
-				workingSetSizes->at(i)->minSize);
-		}
+	if (workingSetSize->minTarget) {
+		isl_set_free(workingSetSize->minTarget);
+	}
 
-		if (workingSetSizes->at(i)->maxSize) {
-			isl_union_pw_qpolynomial_free(
-				workingSetSizes->at(i)->maxSize);
-		}
+	if (workingSetSize->maxTarget) {
+		isl_set_free(workingSetSize->maxTarget);
+	}
 
-		free(workingSetSizes->at(i));
+	if (workingSetSize->minSize) {
+		isl_union_pw_qpolynomial_free(workingSetSize->minSize);
 	}
 
-	delete workingSetSizes;
+	if (workingSetSize->maxSize) {
+		isl_union_pw_qpolynomial_free(workingSetSize->maxSize);
+	}
+
+	if (workingSetSize->dataSetUnionSize) {
+		isl_union_pw_qpolynomial_free(workingSetSize->dataSetUnionSize);
+	}
+
+	if (workingSetSize->dataSetCommonSize) {
+		isl_union_pw_qpolynomial_free(workingSetSize->dataSetCommonSize);
+	}
+
+	if (workingSetSize->numParallelIters) {
+		isl_union_pw_qpolynomial_free(workingSetSize->numParallelIters);
+	}
+
+	if (workingSetSize->indexCounts) {
+		isl_union_pw_qpolynomial_free(workingSetSize->indexCounts);
+	}
+
+	if (workingSetSize->arraySizes) {
+		isl_union_pw_qpolynomial_free(workingSetSize->arraySizes);
+	}
+
+	if (workingSetSize->reusedAccesses) {
+		isl_union_map_free(workingSetSize->reusedAccesses);
+	}
+
+	if (workingSetSize->reusePairs) {
+		isl_union_pw_qpolynomial_free(workingSetSize->reusePairs);
+	}
+
+	delete workingSetSize->conflictSignature;
+	free(workingSetSize);
 }
 
 isl_union_map* IntersetMapWithSet(isl_union_map* map, isl_set* set) {
@@ -2130,13 +3933,24 @@ isl_union_map* IntersetMapWithSet(isl_union_map* map, isl_set* set) {
 
 unordered_map<int, ArrayDataAccesses*>* ComputeDataDependences(
 	UserInput *userInput,
-	isl_ctx* ctx, pet_scop* scop,
+	isl_ctx* ctx, Scop* scop,
 	Config *config) {
 	/*TODO: Print the array because of which the dependence is formed -
 	use "full" dependence structrues*/
-	isl_schedule* schedule = pet_scop_get_schedule(scop);
-	isl_union_map *all_may_reads = pet_scop_get_may_reads(scop);
-	isl_union_map *all_may_writes = pet_scop_get_may_writes(scop);
+	string cacheKey;
+	if (!userInput->cacheDir.empty()) {
+		cacheKey = GetDependencesCacheKey(userInput, scop, config);
+		unordered_map<int, ArrayDataAccesses*>* cachedDependenceMap =
+			ReadDependenceMapFromCache(ctx, userInput->cacheDir, cacheKey);
+
+		if (cachedDependenceMap) {
+			return cachedDependenceMap;
+		}
+	}
+
+	isl_schedule* schedule = isl_schedule_copy(scop->schedule);
+	isl_union_map *all_may_reads = isl_union_map_copy(scop->mayReads);
+	isl_union_map *all_may_writes = isl_union_map_copy(scop->mayWrites);
 
 	unordered_map<int, ArrayDataAccesses*>* dependenceMap =
 		new unordered_map<int, ArrayDataAccesses*>();
@@ -2155,21 +3969,22 @@ unordered_map<int, ArrayDataAccesses*>* ComputeDataDependences(
 
 	if (userInput->perarray) {
 		if (DEBUG) {
-			cout << "scop->n_array: " << scop->n_array << endl;
+			cout << "Number of arrays: " << scop->arrayExtents->size()
+				<< endl;
 		}
 
-		for (int i = 0; i < scop->n_array; i++) {
-			if (scop->arrays[i]->extent) {
+		for (int i = 0; i < scop->arrayExtents->size(); i++) {
+			if (scop->arrayExtents->at(i)) {
 				if (DEBUG) {
-					cout << "scop->arrays[i]->extent: " << endl;
-					PrintSet(scop->arrays[i]->extent);
+					cout << "Array extent: " << endl;
+					PrintSet(scop->arrayExtents->at(i));
 				}
 
 				isl_union_map* may_reads = IntersetMapWithSet(all_may_reads,
-					scop->arrays[i]->extent);
+					scop->arrayExtents->at(i));
 
 				isl_union_map* may_writes = IntersetMapWithSet(all_may_writes,
-					scop->arrays[i]->extent);
+					scop->arrayExtents->at(i));
 
 				if (DEBUG) {
 					cout << "Per-array reads: " << endl;
@@ -2193,9 +4008,359 @@ unordered_map<int, ArrayDataAccesses*>* ComputeDataDependences(
 	}
 
 	isl_schedule_free(schedule);
+
+	/* The dependences are between elements. The data sets between the source
+	and the target of a dependence are counted in the unit of the config */
+	for (auto i : *dependenceMap) {
+		i.second->may_reads = MapAccessesToDataUnits(i.second->may_reads,
+			config);
+		i.second->may_writes = MapAccessesToDataUnits(i.second->may_writes,
+			config);
+	}
+
+	if (!cacheKey.empty() && dependenceMap->size() > 0) {
+		WriteDependenceMapToCache(userInput->cacheDir, cacheKey, dependenceMap);
+	}
+
+	return dependenceMap;
+}
+
+DependenceDeduplication* CreateDependenceDeduplication() {
+	DependenceDeduplication* deduplication = new DependenceDeduplication;
+	deduplication->dependences =
+		new unordered_map<size_t, vector<isl_basic_map*>*>();
+	deduplication->numDependences = 0;
+	deduplication->numDuplicates = 0;
+	return deduplication;
+}
+
+bool IsDuplicateDependence(DependenceDeduplication* deduplication,
+	isl_basic_map* dep) {
+	/* The canonical form has the redundant constraints removed and the
+	implicit equalities made explicit, so that the same relation obtained from,
+	e.g., a RAR and a RAW dependence prints the same. The hash only selects the
+	bucket. Whether the dependence is a duplicate is decided by
+	isl_basic_map_is_equal() */
+	deduplication->numDependences++;
+
+	isl_basic_map* canonicalDep = isl_basic_map_detect_equalities(
+		isl_basic_map_remove_redundancies(isl_basic_map_copy(dep)));
+	size_t hash = std::hash<string>()(BasicMapToString(canonicalDep));
+
+	vector<isl_basic_map*>* bucket;
+	auto found = deduplication->dependences->find(hash);
+	if (found == deduplication->dependences->end()) {
+		bucket = new vector<isl_basic_map*>();
+		deduplication->dependences->insert({ hash, bucket });
+	}
+	else {
+		bucket = found->second;
+	}
+
+	for (int i = 0; i < bucket->size(); i++) {
+		if (isl_basic_map_is_equal(bucket->at(i), canonicalDep) == isl_bool_true) {
+			if (DEBUG) {
+				cout << "Duplicate dependence: " << endl;
+				PrintBasicMap(dep);
+			}
+
+			deduplication->numDuplicates++;
+			isl_basic_map_free(canonicalDep);
+			return true;
+		}
+	}
+
+	bucket->push_back(canonicalDep);
+	return false;
+}
+
+void ClearDependenceDeduplication(DependenceDeduplication* deduplication) {
+	for (auto i : *deduplication->dependences) {
+		for (int j = 0; j < i.second->size(); j++) {
+			isl_basic_map_free(i.second->at(j));
+		}
+
+		delete i.second;
+	}
+
+	deduplication->dependences->clear();
+}
+
+void FreeDependenceDeduplication(DependenceDeduplication* deduplication) {
+	ClearDependenceDeduplication(deduplication);
+	delete deduplication->dependences;
+	delete deduplication;
+}
+
+void ReportDependenceDeduplication(DependenceDeduplication* deduplication) {
+	/* The working sets of a sequential dependence take two card computations,
+	those of a parallel iteration spanning one take more */
+	cout << "Skipped " << deduplication->numDuplicates
+		<< " duplicate dependences out of " << deduplication->numDependences
+		<< ", avoiding at least " << 2 * deduplication->numDuplicates
+		<< " card computations" << endl;
+}
+
+string GetSortedParameterValuesString(unordered_map<string, int>* paramValues) {
+	vector<string> params;
+	for (auto i : *paramValues) {
+		params.push_back(i.first + " = " + to_string(i.second));
+	}
+
+	sort(params.begin(), params.end());
+
+	string paramsString = "";
+	for (int i = 0; i < params.size(); i++) {
+		paramsString += params[i] + " ";
+	}
+
+	return paramsString;
+}
+
+vector<int> GetSortedArrayIds(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap) {
+	vector<int> arrayIds;
+	for (auto i : *dependenceMap) {
+		arrayIds.push_back(i.first);
+	}
+
+	sort(arrayIds.begin(), arrayIds.end());
+	return arrayIds;
+}
+
+string GetDependencesCacheKey(UserInput *userInput, Scop* scop,
+	Config *config) {
+	/* The dependences are computed on the parametric accesses, except when
+	there is only one set of parameters. Then the accesses are specialized to
+	the parameters first, and the parameters become a part of the key. */
+	vector<string> keyParts;
+	keyParts.push_back("dependences");
+	keyParts.push_back(ScopToString(scop));
+	keyParts.push_back(userInput->perarray ? "perarray" : "");
+
+	if (config && config->programParameterVector->size() == 1) {
+		keyParts.push_back(GetSortedParameterValuesString(
+			config->programParameterVector->at(0)));
+	}
+
+	if (config && config->countCacheLines) {
+		keyParts.push_back("cachelines " + to_string(config->systemConfig->lineSize)
+			+ " " + to_string(config->datatypeSize));
+	}
+
+	if (config && config->arrayDatatypeSizes) {
+		vector<string> arrayDatatypeSizes;
+		for (auto i : *config->arrayDatatypeSizes) {
+			arrayDatatypeSizes.push_back(i.first + ":" + to_string(i.second));
+		}
+
+		sort(arrayDatatypeSizes.begin(), arrayDatatypeSizes.end());
+		string key = "datatypesizes";
+		for (int i = 0; i < arrayDatatypeSizes.size(); i++) {
+			key += " " + arrayDatatypeSizes[i];
+		}
+
+		keyParts.push_back(key + " " + to_string(config->datatypeSize));
+	}
+
+	return ComputeAnalysisCacheKey(&keyParts);
+}
+
+string GetWorkingSetSizesCacheKey(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	isl_union_map* schedule, Config *config) {
+	/* The working sets are parametric. Only the parallel loops decide which
+	dependences are analyzed as spanning the iterations of a parallel loop. */
+	vector<string> keyParts;
+	keyParts.push_back("working_sets");
+
+	vector<int> arrayIds = GetSortedArrayIds(dependenceMap);
+	for (int i = 0; i < arrayIds.size(); i++) {
+		ArrayDataAccesses* arrayDataAccesses = dependenceMap->at(arrayIds[i]);
+		keyParts.push_back(to_string(arrayIds[i]));
+		keyParts.push_back(UnionMapToString(arrayDataAccesses->may_reads));
+		keyParts.push_back(UnionMapToString(arrayDataAccesses->may_writes));
+		keyParts.push_back(UnionMapToString(arrayDataAccesses->dependences));
+	}
+
+	if (schedule) {
+		keyParts.push_back(UnionMapToString(schedule));
+	}
+
+	if (config && config->parallelLoops) {
+		string parallelLoops = "";
+		for (int i = 0; i < config->parallelLoops->size(); i++) {
+			parallelLoops += config->parallelLoops->at(i) + " ";
+		}
+
+		keyParts.push_back(parallelLoops);
+	}
+
+	if (config && IsConflictModeled(config->systemConfig)) {
+		keyParts.push_back("conflicts");
+	}
+
+	if (config && config->modelTLB) {
+		keyParts.push_back("tlb");
+	}
+
+	if (config && config->reportArrays) {
+		keyParts.push_back("arrays");
+	}
+
+	if (config && config->modelTraffic) {
+		keyParts.push_back("traffic");
+	}
+
+	if (config && config->reportReuseDistances) {
+		keyParts.push_back("reuse");
+	}
+
+	if (config && IsDependenceBudgeted(config)) {
+		keyParts.push_back("budget " + to_string(config->dependenceTimeout)
+			+ " " + to_string(config->dependenceMaxOperations));
+	}
+
+	return ComputeAnalysisCacheKey(&keyParts);
+}
+
+unordered_map<int, ArrayDataAccesses*>* ReadDependenceMapFromCache(
+	isl_ctx* ctx, string cacheDir, string key) {
+	vector<string> records;
+	if (!ReadAnalysisCacheEntry(cacheDir, key, &records) ||
+		records.size() % 4 != 0) {
+		return NULL;
+	}
+
+	cout << "Reading the dependences from the analysis cache " << key << endl;
+	return DeserializeDependenceMap(ctx, &records);
+}
+
+void WriteDependenceMapToCache(string cacheDir, string key,
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap) {
+	vector<string> records;
+	SerializeDependenceMap(dependenceMap, &records);
+	WriteAnalysisCacheEntry(cacheDir, key, &records);
+}
+
+unordered_map<int, ArrayDataAccesses*>* DeserializeDependenceMap(
+	isl_ctx* ctx, vector<string>* records) {
+	if (records->size() % 4 != 0) {
+		return NULL;
+	}
+
+	/* The arrays are inserted in the increasing order of their ids, as
+	ComputeDataDependences() does */
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap =
+		new unordered_map<int, ArrayDataAccesses*>();
+	for (int i = 0; i < records->size(); i += 4) {
+		ArrayDataAccesses* arrayDataAccesses = new ArrayDataAccesses;
+		arrayDataAccesses->may_reads = UnionMapFromString(ctx, records->at(i + 1));
+		arrayDataAccesses->may_writes = UnionMapFromString(ctx, records->at(i + 2));
+		arrayDataAccesses->dependences = UnionMapFromString(ctx,
+			records->at(i + 3));
+		dependenceMap->insert({ stoi(records->at(i)), arrayDataAccesses });
+	}
+
 	return dependenceMap;
 }
 
+void SerializeDependenceMap(
+	unordered_map<int, ArrayDataAccesses*>* dependenceMap,
+	vector<string>* records) {
+	vector<int> arrayIds = GetSortedArrayIds(dependenceMap);
+	for (int i = 0; i < arrayIds.size(); i++) {
+		ArrayDataAccesses* arrayDataAccesses = dependenceMap->at(arrayIds[i]);
+		records->push_back(to_string(arrayIds[i]));
+		records->push_back(UnionMapToString(arrayDataAccesses->may_reads));
+		records->push_back(UnionMapToString(arrayDataAccesses->may_writes));
+		records->push_back(UnionMapToString(arrayDataAccesses->dependences));
+	}
+}
+
+vector<WorkingSetSize*>* ReadWorkingSetSizesFromCache(isl_ctx* ctx,
+	string cacheDir, string key) {
+	vector<string> records;
+	if (!ReadAnalysisCacheEntry(cacheDir, key, &records) ||
+		records.size() % WORKING_SET_SIZE_RECORDS != 0) {
+		return NULL;
+	}
+
+	cout << "Reading the working sets from the analysis cache " << key << endl;
+
+	vector<WorkingSetSize*>* workingSetSizes = new vector<WorkingSetSize*>();
+	for (int i = 0; i < records.size(); i += WORKING_SET_SIZE_RECORDS) {
+		SerializedWorkingSetSize* serializedWorkingSetSize =
+			ReadWorkingSetSizeRecords(&records, i);
+		workingSetSizes->push_back(DeserializeWorkingSetSize(
+			BasicMapFromString(ctx, serializedWorkingSetSize->dependence),
+			serializedWorkingSetSize));
+		delete serializedWorkingSetSize;
+	}
+
+	return workingSetSizes;
+}
+
+void WriteWorkingSetSizesToCache(string cacheDir, string key,
+	vector<WorkingSetSize*>* workingSetSizes) {
+	vector<string> records;
+	for (int i = 0; i < workingSetSizes->size(); i++) {
+		SerializedWorkingSetSize* serializedWorkingSetSize =
+			SerializeWorkingSetSize(workingSetSizes->at(i));
+		AppendWorkingSetSizeRecords(serializedWorkingSetSize, &records);
+		delete serializedWorkingSetSize;
+	}
+
+	WriteAnalysisCacheEntry(cacheDir, key, &records);
+}
+
+void AppendWorkingSetSizeRecords(
+	SerializedWorkingSetSize* serializedWorkingSetSize, vector<string>* records) {
+	records->push_back(serializedWorkingSetSize->dependence);
+	records->push_back(serializedWorkingSetSize->source);
+	records->push_back(serializedWorkingSetSize->target);
+	records->push_back(serializedWorkingSetSize->minTarget);
+	records->push_back(serializedWorkingSetSize->maxTarget);
+	records->push_back(serializedWorkingSetSize->minSize);
+	records->push_back(serializedWorkingSetSize->maxSize);
+	records->push_back(to_string(serializedWorkingSetSize->parallelLoop));
+	records->push_back(serializedWorkingSetSize->dataSetUnionSize);
+	records->push_back(serializedWorkingSetSize->dataSetCommonSize);
+	records->push_back(serializedWorkingSetSize->numParallelIters);
+	records->push_back(to_string(serializedWorkingSetSize->parallelLoopIndex));
+	records->push_back(serializedWorkingSetSize->conflictSignature);
+	records->push_back(serializedWorkingSetSize->indexCounts);
+	records->push_back(serializedWorkingSetSize->arraySizes);
+	records->push_back(to_string(serializedWorkingSetSize->approximate));
+	records->push_back(serializedWorkingSetSize->reusedAccesses);
+	records->push_back(serializedWorkingSetSize->reusePairs);
+}
+
+SerializedWorkingSetSize* ReadWorkingSetSizeRecords(vector<string>* records,
+	int pos) {
+	SerializedWorkingSetSize* serializedWorkingSetSize =
+		new SerializedWorkingSetSize;
+	serializedWorkingSetSize->dependence = records->at(pos);
+	serializedWorkingSetSize->source = records->at(pos + 1);
+	serializedWorkingSetSize->target = records->at(pos + 2);
+	serializedWorkingSetSize->minTarget = records->at(pos + 3);
+	serializedWorkingSetSize->maxTarget = records->at(pos + 4);
+	serializedWorkingSetSize->minSize = records->at(pos + 5);
+	serializedWorkingSetSize->maxSize = records->at(pos + 6);
+	serializedWorkingSetSize->parallelLoop = records->at(pos + 7) == "1";
+	serializedWorkingSetSize->dataSetUnionSize = records->at(pos + 8);
+	serializedWorkingSetSize->dataSetCommonSize = records->at(pos + 9);
+	serializedWorkingSetSize->numParallelIters = records->at(pos + 10);
+	serializedWorkingSetSize->parallelLoopIndex = stoi(records->at(pos + 11));
+	serializedWorkingSetSize->conflictSignature = records->at(pos + 12);
+	serializedWorkingSetSize->indexCounts = records->at(pos + 13);
+	serializedWorkingSetSize->arraySizes = records->at(pos + 14);
+	serializedWorkingSetSize->approximate = records->at(pos + 15) == "1";
+	serializedWorkingSetSize->reusedAccesses = records->at(pos + 16);
+	serializedWorkingSetSize->reusePairs = records->at(pos + 17);
+	return serializedWorkingSetSize;
+}
+
 ArrayDataAccesses* ComputeAllDataDependences(isl_union_map* may_reads,
 	isl_union_map* may_writes, isl_schedule* schedule) {
 
@@ -2237,8 +4402,10 @@ isl_union_map* ComputeDataDependences(isl_union_map *source,
 	isl_union_access_info_set_schedule(access_info,
 		isl_schedule_copy(schedule));
 
+	ProfileTimer* timer = StartProfileTimer("compute_flow");
 	isl_union_flow *deps =
 		isl_union_access_info_compute_flow(access_info);
+	StopProfileTimer(timer);
 
 	if (DEBUG) {
 		cout << "Dependences are:" << endl;
@@ -2258,12 +4425,1251 @@ isl_union_map* ComputeDataDependences(isl_union_map *source,
 }
 
 
-pet_scop* ParseScop(isl_ctx* ctx, const char *fileName) {
+Scop* ParseScop(isl_ctx* ctx, const char *fileName) {
+	/* The analysis reads the parts of the scop of pet that a scop snapshot
+	holds, so that it runs in the same way on both */
+	ProfileTimer* timer = StartProfileTimer("parse_scop");
 	pet_options_set_autodetect(ctx, 0);
-	pet_scop *scop = pet_scop_extract_from_C_source(ctx, fileName, NULL);
-	if (DEBUG) {
-		PrintScop(ctx, scop);
+	pet_scop *petScop = pet_scop_extract_from_C_source(ctx, fileName, NULL);
+	Scop* scop = ExtractScop(petScop);
+	StopProfileTimer(timer);
+	if (DEBUG && petScop) {
+		PrintScop(ctx, petScop);
 	}
 
+	pet_scop_free(petScop);
 	return scop;
 }
+
+Scop* LoadScop(isl_ctx* ctx, UserInput *userInput, string* dependencesKey,
+	vector<string>* dependenceRecords) {
+	/* Reading a snapshot takes the place of running the front end */
+	ProfileTimer* timer = StartProfileTimer("parse_scop");
+	Scop* scop = ReadScopSnapshot(ctx, userInput->loadScop, userInput->quiet,
+		dependencesKey, dependenceRecords);
+	StopProfileTimer(timer);
+	if (DEBUG && scop) {
+		cout << "Scop: " << endl << ScopToString(scop);
+	}
+
+	return scop;
+}
+
+isl_union_pw_qpolynomial* ComputeUnionSetCard(isl_union_set* set) {
+	ProfileTimer* timer = StartProfileTimer("card");
+	isl_union_pw_qpolynomial* card = isl_union_set_card(set);
+	StopProfileTimer(timer);
+	return card;
+}
+
+isl_union_pw_qpolynomial* ComputeUnionMapCard(isl_union_map* map) {
+	ProfileTimer* timer = StartProfileTimer("card");
+	isl_union_pw_qpolynomial* card = isl_union_map_card(map);
+	StopProfileTimer(timer);
+	return card;
+}
+
+int GetDataUnitSize(Config *config) {
+	/* The size in bytes of the unit in which the data sets are counted */
+	if (config->countCacheLines) {
+		return config->systemConfig->lineSize;
+	}
+
+	if (config->arrayDatatypeSizes) {
+		return 1;
+	}
+
+	return config->datatypeSize;
+}
+
+isl_union_map* MapAccessesToDataUnits(isl_union_map* accesses,
+	Config *config) {
+	/* Maps the elements accessed to the units in which the data sets are
+	counted. With --cachelines, they are the cache lines that hold them. The
+	rows of an array, i.e., its innermost dimension, are assumed to start at a
+	line boundary, and the innermost index is divided by the number of elements
+	in a line. Thus, A[i][j] is mapped to A[i][floor(j / (lineSize /
+	datatypeSize))]. With data type sizes per array, they are the bytes of the
+	elements, so that the arrays of different data types are counted together.
+	Thus, A[i][j] is mapped to A[i][datatypeSize * j + b], 0 <= b < datatypeSize. */
+	if (config == NULL ||
+		(!config->countCacheLines && config->arrayDatatypeSizes == NULL)) {
+		return accesses;
+	}
+
+	isl_union_map* dataUnitMap = isl_union_map_empty(
+		isl_union_map_get_space(accesses));
+	isl_union_set* arrays = isl_union_map_range(isl_union_map_copy(accesses));
+	DataUnitMapping mapping;
+	mapping.config = config;
+	mapping.dataUnitMap = dataUnitMap;
+	isl_union_set_foreach_set(arrays, &AddDataUnitMapForArray, &mapping);
+	isl_union_set_free(arrays);
+
+	return isl_union_map_apply_range(accesses, mapping.dataUnitMap);
+}
+
+isl_stat AddDataUnitMapForArray(isl_set* array, void* user) {
+	DataUnitMapping* mapping = (DataUnitMapping*)user;
+	Config* config = mapping->config;
+	const char* name = isl_set_get_tuple_name(array);
+	long datatypeSize = GetArrayDatatypeSize(config, name ? name : "");
+	isl_space* space = isl_space_map_from_set(isl_set_get_space(array));
+	isl_size numDims = isl_set_dim(array, isl_dim_set);
+	isl_set_free(array);
+
+	long elementsPerLine = config->systemConfig->lineSize / datatypeSize;
+	isl_map* map = NULL;
+	if (numDims == 0 || (config->countCacheLines && elementsPerLine <= 1) ||
+		(!config->countCacheLines && datatypeSize == 1)) {
+		map = isl_map_identity(space);
+	}
+	else if (config->countCacheLines) {
+		isl_multi_aff* lineIndex = isl_multi_aff_identity(space);
+		isl_aff* innermostIndex = isl_multi_aff_get_aff(lineIndex, numDims - 1);
+		innermostIndex = isl_aff_floor(isl_aff_scale_down_ui(innermostIndex,
+			elementsPerLine));
+		lineIndex = isl_multi_aff_set_aff(lineIndex, numDims - 1, innermostIndex);
+		map = isl_map_from_multi_aff(lineIndex);
+	}
+	else {
+		map = MapElementsToBytes(space, numDims, datatypeSize);
+	}
+
+	mapping->dataUnitMap = isl_union_map_add_map(mapping->dataUnitMap, map);
+	return isl_stat_ok;
+}
+
+isl_map* MapElementsToBytes(isl_space* space, int numDims, long datatypeSize) {
+	/* { A[i, j] -> A[i, b] : datatypeSize * j <= b < datatypeSize * (j + 1) } */
+	isl_map* map = isl_map_universe(isl_space_copy(space));
+	for (int i = 0; i < numDims - 1; i++) {
+		map = isl_map_equate(map, isl_dim_in, i, isl_dim_out, i);
+	}
+
+	isl_local_space* localSpace = isl_local_space_from_space(space);
+	isl_constraint* lowerBound = isl_inequality_alloc(
+		isl_local_space_copy(localSpace));
+	lowerBound = isl_constraint_set_coefficient_si(lowerBound, isl_dim_out,
+		numDims - 1, 1);
+	lowerBound = isl_constraint_set_coefficient_si(lowerBound, isl_dim_in,
+		numDims - 1, -datatypeSize);
+	map = isl_map_add_constraint(map, lowerBound);
+
+	isl_constraint* upperBound = isl_inequality_alloc(localSpace);
+	upperBound = isl_constraint_set_coefficient_si(upperBound, isl_dim_out,
+		numDims - 1, -1);
+	upperBound = isl_constraint_set_coefficient_si(upperBound, isl_dim_in,
+		numDims - 1, datatypeSize);
+	upperBound = isl_constraint_set_constant_si(upperBound, datatypeSize - 1);
+	return isl_map_add_constraint(map, upperBound);
+}
+
+bool IsConflictModeled(SystemConfig* systemConfig) {
+	return systemConfig->L1Sets > 0 || systemConfig->L2Sets > 0 ||
+		systemConfig->L3Sets > 0;
+}
+
+string* ComputeConflictSignature(isl_union_set* dataSet) {
+	/* Records, for every array of the data set, whether each of its dimensions
+	takes more than one value in the data set, e.g., "A:011 B:11". The lines of
+	the array then map to the cache sets by the strides of the varying
+	dimensions. */
+	string* conflictSignature = new string();
+	isl_union_set_foreach_set(dataSet, &AddArrayToConflictSignature,
+		conflictSignature);
+	return conflictSignature;
+}
+
+isl_stat AddArrayToConflictSignature(isl_set* array, void* user) {
+	string* conflictSignature = (string*)user;
+	const char* name = isl_set_get_tuple_name(array);
+	isl_size numDims = isl_set_dim(array, isl_dim_set);
+
+	if (name != NULL) {
+		string varyingDims = "";
+		for (int i = 0; i < numDims; i++) {
+			isl_pw_aff* minIndex = isl_set_dim_min(isl_set_copy(array), i);
+			isl_pw_aff* maxIndex = isl_set_dim_max(isl_set_copy(array), i);
+
+			/* A dimension that is not known to be fixed is taken to vary */
+			if (isl_pw_aff_is_equal(minIndex, maxIndex) == isl_bool_true) {
+				varyingDims += "0";
+			}
+			else {
+				varyingDims += "1";
+			}
+
+			isl_pw_aff_free(minIndex);
+			isl_pw_aff_free(maxIndex);
+		}
+
+		if (!conflictSignature->empty()) {
+			*conflictSignature += " ";
+		}
+
+		*conflictSignature += string(name) + ":" + varyingDims;
+	}
+
+	isl_set_free(array);
+	return isl_stat_ok;
+}
+
+unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* ComputeArrayExtents(
+	Scop* scop) {
+	/* The number of elements along each dimension of every array. The
+	outermost dimension does not contribute to the strides and is not counted,
+	nor is a dimension whose extent is not bounded. */
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents =
+		new unordered_map<string, vector<isl_union_pw_qpolynomial*>*>();
+
+	for (int i = 0; i < scop->arrayExtents->size(); i++) {
+		isl_set* extent = scop->arrayExtents->at(i);
+		const char* name = isl_set_get_tuple_name(extent);
+		if (name == NULL || arrayExtents->find(name) != arrayExtents->end()) {
+			continue;
+		}
+
+		isl_size numDims = isl_set_dim(extent, isl_dim_set);
+		vector<isl_union_pw_qpolynomial*>* extents =
+			new vector<isl_union_pw_qpolynomial*>();
+		extents->push_back(NULL);
+		for (int j = 1; j < numDims; j++) {
+			isl_set* dimValues = isl_set_project_out(isl_set_copy(extent),
+				isl_dim_set, j + 1, numDims - j - 1);
+			dimValues = isl_set_project_out(dimValues, isl_dim_set, 0, j);
+
+			if (isl_set_is_bounded(dimValues) == isl_bool_true) {
+				extents->push_back(ComputeUnionSetCard(
+					isl_union_set_from_set(dimValues)));
+			}
+			else {
+				isl_set_free(dimValues);
+				extents->push_back(NULL);
+			}
+		}
+
+		arrayExtents->insert({ name, extents });
+	}
+
+	return arrayExtents;
+}
+
+void FreeArrayExtents(
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents) {
+	if (arrayExtents == NULL) {
+		return;
+	}
+
+	for (auto i : *arrayExtents) {
+		for (int j = 0; j < i.second->size(); j++) {
+			if (i.second->at(j)) {
+				isl_union_pw_qpolynomial_free(i.second->at(j));
+			}
+		}
+
+		delete i.second;
+	}
+
+	delete arrayExtents;
+}
+
+void EvaluateArrayExtents(
+	unordered_map<string, vector<isl_union_pw_qpolynomial*>*>* arrayExtents,
+	ParameterBinding* binding,
+	unordered_map<string, vector<long>>* arrayExtentValues) {
+	/* An extent that is not known is -1 */
+	arrayExtentValues->clear();
+	for (auto i : *arrayExtents) {
+		vector<long> extentValues;
+		for (int j = 0; j < i.second->size(); j++) {
+			long extentValue = -1;
+			if (i.second->at(j) == NULL ||
+				!EvaluateUnionPwQpolynomial(i.second->at(j), binding, &extentValue)) {
+				extentValue = -1;
+			}
+
+			extentValues.push_back(extentValue);
+		}
+
+		arrayExtentValues->insert({ i.first, extentValues });
+	}
+}
+
+void ComputeConflictFactors(string* conflictSignature,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	Config* config, double* conflictFactors) {
+	SystemConfig* systemConfig = config->systemConfig;
+	/* The factor of a cache is the number of its sets over the number of sets
+	the lines of the working set can map to. It is taken from the array of the
+	working set that maps to the fewest sets. */
+	long numSets[3] = { systemConfig->L1Sets, systemConfig->L2Sets,
+		systemConfig->L3Sets };
+	for (int i = 0; i < 3; i++) {
+		conflictFactors[i] = 1.0;
+	}
+
+	if (conflictSignature == NULL) {
+		return;
+	}
+
+	istringstream iss(*conflictSignature);
+	string array;
+	while (iss >> array) {
+		size_t pos = array.rfind(':');
+		auto found = arrayExtentValues->find(array.substr(0, pos));
+		if (pos == string::npos || found == arrayExtentValues->end()) {
+			continue;
+		}
+
+		for (int i = 0; i < 3; i++) {
+			if (numSets[i] <= 0) {
+				continue;
+			}
+
+			long usableSets = ComputeUsableCacheSets(numSets[i],
+				systemConfig->lineSize, &found->second, array.substr(pos + 1),
+				GetArrayDatatypeSize(config, array.substr(0, pos)));
+			conflictFactors[i] = max(conflictFactors[i],
+				(double)numSets[i] / usableSets);
+		}
+	}
+
+	if (DEBUG) {
+		cout << "Conflict factors of " << *conflictSignature << ": "
+			<< conflictFactors[0] << " " << conflictFactors[1] << " "
+			<< conflictFactors[2] << endl;
+	}
+}
+
+long ComputeUsableCacheSets(long numSets, long lineSize, vector<long>* extents,
+	string varyingDims, long elementSize) {
+	/* A line maps to the set (address / lineSize) % numSets. The rows of the
+	array that the working set spans are apart by multiples of the strides of
+	its varying outer dimensions, and therefore start at the offsets, modulo the
+	size of a way, that are multiples of the gcd of the strides. Each row covers
+	the lines from its offset onwards. E.g., with 64 sets of 64 bytes, rows 4 KB
+	apart all start in the same set, and rows 4 KB + 64 bytes apart do not. */
+	long waySize = numSets * lineSize;
+	int numDims = extents->size();
+	if (varyingDims.size() != numDims || numDims < 2) {
+		return numSets;
+	}
+
+	long stride = elementSize % waySize;
+	long strideGcd = waySize;
+	bool isOuterDimVarying = false;
+	for (int i = numDims - 2; i >= 0; i--) {
+		if (extents->at(i + 1) <= 0) {
+			return numSets;
+		}
+
+		// The stride of dimension i, modulo the size of a way
+		stride = (stride * (extents->at(i + 1) % waySize)) % waySize;
+		if (varyingDims[i] == '1') {
+			strideGcd = ComputeGcd(strideGcd, stride);
+			isOuterDimVarying = true;
+		}
+	}
+
+	if (!isOuterDimVarying || strideGcd <= lineSize) {
+		return numSets;
+	}
+
+	long rowSize = elementSize;
+	if (varyingDims[numDims - 1] == '1') {
+		rowSize = elementSize * extents->at(numDims - 1);
+	}
+
+	long linesPerRow = (min(rowSize, strideGcd) + lineSize - 1) / lineSize;
+	return min(numSets, (waySize / strideGcd) * linesPerRow);
+}
+
+long ApplyConflictFactor(long size, double* conflictFactors, int level) {
+	if (conflictFactors == NULL || conflictFactors[level] <= 1.0) {
+		return size;
+	}
+
+	return (long)ceil(size * conflictFactors[level]);
+}
+
+void RecordDataSetFeatures(isl_union_set* dataSet,
+	DataSetFeatureRecorder* recorder) {
+	if (recorder->conflictSignature) {
+		recorder->workingSetSize->conflictSignature =
+			ComputeConflictSignature(dataSet);
+	}
+
+	if (recorder->indexCounts) {
+		recorder->workingSetSize->indexCounts = ComputeIndexCounts(dataSet);
+	}
+
+	if (recorder->arraySizes) {
+		recorder->workingSetSize->arraySizes = ComputeArraySizes(dataSet);
+	}
+}
+
+isl_union_pw_qpolynomial* ComputeIndexCounts(isl_union_set* dataSet) {
+	/* The values of dimension j of array A in the data set are the range of a
+	map from the space A__dim<j>[], and all the maps are counted at once. The
+	cardinality of a union set would add up the counts of all its spaces. */
+	isl_union_map* indexValues = isl_union_map_empty(
+		isl_union_set_get_space(dataSet));
+	isl_union_set_foreach_set(dataSet, &AddArrayIndexValues, &indexValues);
+	return ComputeDataMapCard(indexValues);
+}
+
+isl_stat AddArrayIndexValues(isl_set* array, void* user) {
+	isl_union_map** indexValues = (isl_union_map**)user;
+	const char* name = isl_set_get_tuple_name(array);
+	isl_size numDims = isl_set_dim(array, isl_dim_set);
+
+	for (int i = 0; name != NULL && i < numDims; i++) {
+		isl_set* dimValues = isl_set_project_out(isl_set_copy(array),
+			isl_dim_set, i + 1, numDims - i - 1);
+		dimValues = isl_set_project_out(dimValues, isl_dim_set, 0, i);
+		string dimName = string(name) + "__dim" + to_string(i);
+		isl_map* dimValuesMap = isl_map_set_tuple_name(
+			isl_map_from_range(dimValues), isl_dim_in, dimName.c_str());
+		*indexValues = isl_union_map_add_map(*indexValues, dimValuesMap);
+	}
+
+	isl_set_free(array);
+	return isl_stat_ok;
+}
+
+struct IndexCountEvaluation {
+	ParameterBinding* binding;
+	unordered_map<string, vector<long>>* indexCounts;
+};
+
+typedef struct IndexCountEvaluation IndexCountEvaluation;
+
+isl_stat EvaluateIndexCount(isl_pw_qpolynomial* indexCount, void* user) {
+	IndexCountEvaluation* evaluation = (IndexCountEvaluation*)user;
+	isl_space* space = isl_pw_qpolynomial_get_domain_space(indexCount);
+	const char* name = isl_space_get_tuple_name(space, isl_dim_set);
+	string dimName = name ? name : "";
+	isl_space_free(space);
+
+	isl_union_pw_qpolynomial* count =
+		isl_union_pw_qpolynomial_from_pw_qpolynomial(indexCount);
+	size_t pos = dimName.rfind("__dim");
+	long value = -1;
+	if (!EvaluateUnionPwQpolynomial(count, evaluation->binding, &value)) {
+		value = -1;
+	}
+
+	isl_union_pw_qpolynomial_free(count);
+
+	if (pos != string::npos) {
+		vector<long>* counts = &(*evaluation->indexCounts)[dimName.substr(0, pos)];
+		int dim = stoi(dimName.substr(pos + 5));
+		if (counts->size() <= dim) {
+			counts->resize(dim + 1, -1);
+		}
+
+		counts->at(dim) = value;
+	}
+
+	return isl_stat_ok;
+}
+
+long ComputeWorkingSetPages(WorkingSetSize* workingSetSize,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	ParameterBinding* binding, Config* config) {
+	if (workingSetSize->indexCounts == NULL) {
+		return -1;
+	}
+
+	unordered_map<string, vector<long>> indexCounts;
+	IndexCountEvaluation evaluation;
+	evaluation.binding = binding;
+	evaluation.indexCounts = &indexCounts;
+	isl_union_pw_qpolynomial_foreach_pw_qpolynomial(workingSetSize->indexCounts,
+		&EvaluateIndexCount, &evaluation);
+
+	long pages = 0;
+	for (auto i : indexCounts) {
+		vector<long> extents;
+		auto found = arrayExtentValues->find(i.first);
+		if (found != arrayExtentValues->end()) {
+			extents = found->second;
+		}
+
+		extents.resize(i.second.size(), -1);
+
+		// The innermost index is that of a line with --cachelines, and that of
+		// a byte with data type sizes per array
+		long datatypeSize = GetArrayDatatypeSize(config, i.first);
+		if (!i.second.empty() && i.second.back() > 0) {
+			if (config->countCacheLines) {
+				i.second.back() *= max(1L,
+					config->systemConfig->lineSize / datatypeSize);
+			}
+			else if (config->arrayDatatypeSizes) {
+				i.second.back() = (i.second.back() + datatypeSize - 1) / datatypeSize;
+			}
+		}
+
+		pages += ComputePageFootprint(&i.second, &extents, datatypeSize,
+			config->systemConfig->pageSize);
+	}
+
+	return pages;
+}
+
+long ComputePageFootprint(vector<long>* indexCounts, vector<long>* extents,
+	long elementSize, long pageSize) {
+	/* The pages touched by an array of which indexCounts values of each
+	dimension are accessed. From the innermost dimension outwards, the values
+	of a dimension whose stride is less than a page are taken to be contiguous,
+	so that all the pages of the span of its accesses are touched. The values
+	of a dimension whose stride is a page or more touch pages of their own. */
+	long pages = 1;
+	long span = elementSize; // the bytes spanned by the inner dimensions
+	long stride = elementSize;
+	for (int i = indexCounts->size() - 1; i >= 0; i--) {
+		long count = max(1L, indexCounts->at(i));
+
+		if (i < indexCounts->size() - 1 && stride < pageSize) {
+			// An unknown extent is taken to be a page or more
+			stride = extents->at(i + 1) > 0 ? stride * extents->at(i + 1) :
+				pageSize;
+		}
+
+		if (stride >= pageSize) {
+			pages *= count;
+		}
+		else {
+			span = (count - 1) * stride + span;
+			pages = min(count * pages, (span + pageSize - 1) / pageSize);
+		}
+	}
+
+	return pages;
+}
+
+void ComputeTLBFit(vector<WorkingSetSize*>* workingSetSizes,
+	unordered_map<string, vector<long>>* arrayExtentValues,
+	ParameterBinding* binding, Config* config, long* pages) {
+	/* The pages of the working sets are placed in the DTLB, the STLB, or
+	missed in both and walked, as the data sets are placed in the caches by
+	UpdatePessimisticProgramCharacteristics(): from the smallest working set
+	onwards, to the first TLB that the pages placed in it so far leave room
+	in. Working sets of the same number of pages are placed once. */
+	vector<long> workingSetPages;
+	for (int i = 0; i < workingSetSizes->size(); i++) {
+		long numPages = ComputeWorkingSetPages(workingSetSizes->at(i),
+			arrayExtentValues, binding, config);
+		if (numPages > 0 && find(workingSetPages.begin(), workingSetPages.end(),
+			numPages) == workingSetPages.end()) {
+			workingSetPages.push_back(numPages);
+		}
+	}
+
+	sort(workingSetPages.begin(), workingSetPages.end());
+
+	pages[0] = pages[1] = pages[2] = 0;
+	for (int i = 0; i < workingSetPages.size(); i++) {
+		long numPages = workingSetPages[i];
+		if (numPages + pages[0] <= config->systemConfig->DTLBEntries) {
+			pages[0] += numPages;
+		}
+		else if (numPages + pages[1] <= config->systemConfig->STLBEntries) {
+			pages[1] += numPages;
+		}
+		else {
+			pages[2] += numPages;
+		}
+	}
+
+	if (DEBUG) {
+		cout << "DTLB, STLB and walked pages: " << pages[0] << " " << pages[1]
+			<< " " << pages[2] << endl;
+	}
+}
+
+isl_union_pw_qpolynomial* ComputeArraySizes(isl_union_set* dataSet) {
+	return ComputeDataMapCard(MapArrayNamesToData(isl_union_set_copy(dataSet)));
+}
+
+isl_union_map* MapArrayNamesToData(isl_union_set* dataSet) {
+	/* The data of array A in the data set are the range of a map from the
+	space A[], so that the count of every array keeps its name */
+	isl_union_map* arrayData = isl_union_map_empty(
+		isl_union_set_get_space(dataSet));
+	isl_union_set_foreach_set(dataSet, &AddArrayNameToData, &arrayData);
+	isl_union_set_free(dataSet);
+	return arrayData;
+}
+
+isl_stat AddArrayNameToData(isl_set* array, void* user) {
+	isl_union_map** arrayData = (isl_union_map**)user;
+	const char* name = isl_set_get_tuple_name(array);
+
+	if (name == NULL) {
+		isl_set_free(array);
+		return isl_stat_ok;
+	}
+
+	string arrayName = name;
+	isl_map* arrayDataMap = isl_map_set_tuple_name(isl_map_from_range(array),
+		isl_dim_in, arrayName.c_str());
+	*arrayData = isl_union_map_add_map(*arrayData, arrayDataMap);
+	return isl_stat_ok;
+}
+
+struct ArraySizeEvaluation {
+	ParameterBinding* binding;
+	unordered_map<string, long>* arraySizeValues;
+};
+
+typedef struct ArraySizeEvaluation ArraySizeEvaluation;
+
+void EvaluateArraySizes(isl_union_pw_qpolynomial* arraySizes,
+	ParameterBinding* binding, unordered_map<string, long>* arraySizeValues) {
+	if (arraySizes == NULL) {
+		return;
+	}
+
+	ArraySizeEvaluation evaluation;
+	evaluation.binding = binding;
+	evaluation.arraySizeValues = arraySizeValues;
+	isl_union_pw_qpolynomial_foreach_pw_qpolynomial(arraySizes,
+		&EvaluateArraySize, &evaluation);
+}
+
+isl_stat EvaluateArraySize(isl_pw_qpolynomial* arraySize, void* user) {
+	ArraySizeEvaluation* evaluation = (ArraySizeEvaluation*)user;
+	isl_space* space = isl_pw_qpolynomial_get_domain_space(arraySize);
+	const char* name = isl_space_get_tuple_name(space, isl_dim_set);
+	string arrayName = name ? name : "";
+	isl_space_free(space);
+
+	isl_union_pw_qpolynomial* size =
+		isl_union_pw_qpolynomial_from_pw_qpolynomial(arraySize);
+	long value = -1;
+	if (!EvaluateUnionPwQpolynomial(size, evaluation->binding, &value)) {
+		value = -1;
+	}
+
+	isl_union_pw_qpolynomial_free(size);
+
+	if (!arrayName.empty() && value > 0) {
+		(*evaluation->arraySizeValues)[arrayName] += value;
+	}
+
+	return isl_stat_ok;
+}
+
+void AddArrayResidencies(MinMaxTuple* minMaxTuple, long* placedBytes,
+	ParameterBinding* binding, map<string, ArrayResidency>* residencies) {
+	/* The bytes of the working set placed in each cache and the memory are
+	split across its arrays in the proportions of their data in its largest data
+	set. Every array of the working set is reused from where its bytes are. */
+	if (minMaxTuple->workingSetSize == NULL) {
+		return;
+	}
+
+	unordered_map<string, long> arraySizeValues;
+	EvaluateArraySizes(minMaxTuple->workingSetSize->arraySizes, binding,
+		&arraySizeValues);
+
+	long total = 0;
+	for (auto i : arraySizeValues) {
+		total += i.second;
+	}
+
+	if (total <= 0) {
+		return;
+	}
+
+	for (auto i : arraySizeValues) {
+		auto found = residencies->find(i.first);
+		if (found == residencies->end()) {
+			ArrayResidency residency;
+			for (int level = 0; level < 4; level++) {
+				residency.bytes[level] = 0;
+				residency.reuses[level] = 0;
+			}
+
+			found = residencies->insert({ i.first, residency }).first;
+		}
+
+		for (int level = 0; level < 4; level++) {
+			if (placedBytes[level] > 0) {
+				found->second.bytes[level] +=
+					((double)placedBytes[level]) * i.second / total;
+				found->second.reuses[level] += 1;
+			}
+		}
+	}
+}
+
+bool IsDependenceBudgeted(Config* config) {
+	return config->dependenceTimeout > 0 || config->dependenceMaxOperations > 0;
+}
+
+isl_union_pw_qpolynomial* ComputeDataSetCard(isl_union_set* dataSet) {
+	/* A data set bounded by a box is bounded array by array, and the bounds
+	are added up over the parameters, as in the count of the data set */
+	if (!boundDataSetCards) {
+		return ComputeUnionSetCard(dataSet);
+	}
+
+	isl_union_pw_qpolynomial* card = isl_union_pw_qpolynomial_zero(
+		isl_union_set_get_space(dataSet));
+	isl_union_pw_qpolynomial* arrayCards = ComputeDataMapCard(
+		MapArrayNamesToData(dataSet));
+	isl_union_pw_qpolynomial_foreach_pw_qpolynomial(arrayCards,
+		&AddCardOnParams, &card);
+	isl_union_pw_qpolynomial_free(arrayCards);
+	return card;
+}
+
+isl_stat AddCardOnParams(isl_pw_qpolynomial* card, void* user) {
+	isl_union_pw_qpolynomial** sum = (isl_union_pw_qpolynomial**)user;
+	*sum = isl_union_pw_qpolynomial_add_pw_qpolynomial(*sum,
+		isl_pw_qpolynomial_project_domain_on_params(card));
+	return isl_stat_ok;
+}
+
+isl_union_pw_qpolynomial* ComputeDataMapCard(isl_union_map* map) {
+	/* The maps are from named spaces of no dimensions, and the counts of their
+	ranges keep the names */
+	if (!boundDataSetCards) {
+		return ComputeUnionMapCard(map);
+	}
+
+	ProfileTimer* timer = StartProfileTimer("bound");
+	isl_union_pw_qpolynomial* card = isl_union_pw_qpolynomial_zero(
+		isl_union_map_get_space(map));
+	isl_union_map_foreach_map(map, &AddBoundingBoxCard, &card);
+	isl_union_map_free(map);
+	StopProfileTimer(timer);
+	return card;
+}
+
+isl_stat AddBoundingBoxCard(isl_map* map, void* user) {
+	isl_union_pw_qpolynomial** card = (isl_union_pw_qpolynomial**)user;
+	*card = isl_union_pw_qpolynomial_add_pw_qpolynomial(*card,
+		ComputeBoundingBoxCard(map));
+	return isl_stat_ok;
+}
+
+isl_pw_qpolynomial* ComputeBoundingBoxCard(isl_map* map) {
+	/* An upper bound on the number of elements of the range of the map: the
+	product of the extents of its projections on each of its dimensions */
+	isl_ctx* ctx = isl_map_get_ctx(map);
+	isl_pw_qpolynomial* card = isl_pw_qpolynomial_from_pw_aff(
+		isl_pw_aff_val_on_domain(isl_map_domain(isl_map_copy(map)),
+			isl_val_one(ctx)));
+
+	isl_size numDims = isl_map_dim(map, isl_dim_out);
+	for (int i = 0; i < numDims; i++) {
+		isl_pw_aff* extent = isl_pw_aff_sub(isl_map_dim_max(isl_map_copy(map), i),
+			isl_map_dim_min(isl_map_copy(map), i));
+		extent = isl_pw_aff_add(extent, isl_pw_aff_val_on_domain(
+			isl_pw_aff_domain(isl_pw_aff_copy(extent)), isl_val_one(ctx)));
+		card = isl_pw_qpolynomial_mul(card,
+			isl_pw_qpolynomial_from_pw_aff(extent));
+	}
+
+	isl_map_free(map);
+	return card;
+}
+
+isl_union_map* ComputeReusedAccesses(isl_basic_map* dep,
+	isl_union_map* may_reads, isl_union_map* may_writes) {
+	/* The accesses of the targets of the dependence to the data units that
+	its sources accessed */
+	isl_union_map* accesses = isl_union_map_union(
+		isl_union_map_copy(may_reads), isl_union_map_copy(may_writes));
+	isl_union_map* sourceData = isl_union_map_apply_range(
+		isl_union_map_reverse(isl_union_map_from_basic_map(
+			isl_basic_map_copy(dep))),
+		isl_union_map_copy(accesses));
+	return isl_union_map_intersect(sourceData, accesses);
+}
+
+void ComputeTraffic(vector<WorkingSetSize*>* workingSetSizes,
+	vector<MinMaxTuple*>* workingSetTuples, isl_union_map* reads,
+	isl_union_map* writes, unordered_map<string, int>* paramValues,
+	ParameterBinding* binding, Config* config, long* traffic) {
+	/* An access hits in a cache if it reuses the data of the source of a
+	dependence whose working set is placed in that cache or a smaller one, and
+	misses otherwise, e.g., the first access to every data unit. A read that
+	misses is read from the next level, and so is a write that misses unless
+	its statement instance read the data unit too (write-allocate). A write
+	that misses leaves a dirty data unit that is eventually written back to the
+	next level. The traffic out of L1, L2 and L3 is that of the reads,
+	write-allocates and write-backs in bytes, for all the iterations. */
+	ProfileTimer* timer = StartProfileTimer("traffic");
+	isl_set* context = ConstructContextEquatingParametersToConstants(
+		isl_union_map_get_space(reads), paramValues);
+	isl_union_map* fixedReads = isl_union_map_intersect_params(
+		isl_union_map_copy(reads), isl_set_copy(context));
+	isl_union_map* fixedWrites = isl_union_map_intersect_params(
+		isl_union_map_copy(writes), isl_set_copy(context));
+	isl_union_map* writeOnly = isl_union_map_subtract(
+		isl_union_map_copy(fixedWrites), isl_union_map_copy(fixedReads));
+	long unitSize = GetDataUnitSize(config);
+
+	isl_union_map* hits = isl_union_map_empty(isl_union_map_get_space(reads));
+	for (int level = 0; level < 3; level++) {
+		for (int i = 0; i < workingSetSizes->size(); i++) {
+			MinMaxTuple* minMaxTuple = workingSetTuples->at(i);
+			if (minMaxTuple && minMaxTuple->level == level &&
+				workingSetSizes->at(i)->reusedAccesses) {
+				hits = isl_union_map_union(hits, isl_union_map_intersect_params(
+					isl_union_map_copy(workingSetSizes->at(i)->reusedAccesses),
+					isl_set_copy(context)));
+			}
+		}
+
+		traffic[3 * level] = CountMissedAccesses(fixedReads, hits, binding);
+		traffic[3 * level + 1] = CountMissedAccesses(writeOnly, hits, binding);
+		traffic[3 * level + 2] = CountMissedAccesses(fixedWrites, hits, binding);
+
+		for (int k = 3 * level; k < 3 * level + 3; k++) {
+			if (traffic[k] != -1) {
+				traffic[k] = traffic[k] * unitSize;
+			}
+		}
+	}
+
+	isl_union_map_free(hits);
+	isl_union_map_free(fixedReads);
+	isl_union_map_free(fixedWrites);
+	isl_union_map_free(writeOnly);
+	isl_set_free(context);
+	StopProfileTimer(timer);
+}
+
+long CountMissedAccesses(isl_union_map* accesses, isl_union_map* hits,
+	ParameterBinding* binding) {
+	isl_union_map* missed = isl_union_map_subtract(isl_union_map_copy(accesses),
+		isl_union_map_copy(hits));
+	if (isl_union_map_is_empty(missed) == isl_bool_true) {
+		isl_union_map_free(missed);
+		return 0;
+	}
+
+	isl_union_pw_qpolynomial* card = ComputeUnionMapCard(missed);
+	long value = -1;
+	if (!EvaluateUnionPwQpolynomial(card, binding, &value)) {
+		value = -1;
+	}
+
+	isl_union_pw_qpolynomial_free(card);
+	return value;
+}
+
+isl_union_pw_qpolynomial* ComputeFlopCount(Scop* scop) {
+	/* The flops of the scop are the flops of an instance of every statement
+	times the number of its instances, as a function of the parameters */
+	isl_union_pw_qpolynomial* flopCount = isl_union_pw_qpolynomial_zero(
+		isl_set_get_space(scop->context));
+
+	for (int i = 0; i < scop->statements->size(); i++) {
+		int flops = scop->statements->at(i).flops;
+		if (flops == 0) {
+			continue;
+		}
+
+		isl_pw_qpolynomial* card = isl_set_card(
+			isl_set_copy(scop->statements->at(i).domain));
+		card = isl_pw_qpolynomial_scale_val(card,
+			isl_val_int_from_si(isl_set_get_ctx(scop->context), flops));
+		flopCount = isl_union_pw_qpolynomial_add_pw_qpolynomial(flopCount,
+			card);
+	}
+
+	if (DEBUG) {
+		cout << "Flop count: " << endl;
+		PrintUnionPwQpolynomial(flopCount);
+	}
+
+	return flopCount;
+}
+
+string PredictRoofline(long flops, long* traffic, SystemConfig* systemConfig,
+	double* gflops) {
+	/* The time of the variant is bounded by that of its flops at the peak and
+	by that of the bytes moved out of L2, L3 and the memory at their
+	bandwidths. The largest bound is the predicted time and its level binds. */
+	*gflops = -1;
+	if (flops == -1) {
+		return "Unknown";
+	}
+
+	double time = flops / (systemConfig->peakGflops * 1e9);
+	string bindingLevel = "Compute";
+	double bandwidths[3] = { systemConfig->L2Bandwidth,
+		systemConfig->L3Bandwidth, systemConfig->MemBandwidth };
+	string levels[3] = { "L2", "L3", "Mem" };
+	for (int level = 0; level < 3; level++) {
+		if (bandwidths[level] <= 0) {
+			continue;
+		}
+
+		if (traffic[3 * level] == -1 || traffic[3 * level + 1] == -1 ||
+			traffic[3 * level + 2] == -1) {
+			return "Unknown";
+		}
+
+		long bytes = traffic[3 * level] + traffic[3 * level + 1]
+			+ traffic[3 * level + 2];
+		double levelTime = bytes / (bandwidths[level] * 1e9);
+		if (levelTime > time) {
+			time = levelTime;
+			bindingLevel = levels[level];
+		}
+	}
+
+	*gflops = time > 0 ? flops / time / 1e9 : 0;
+	return bindingLevel;
+}
+
+void SimulateCachesForParameterValues(UserInput *userInput, Config *config,
+	Scop* scop) {
+	/* The hits and the misses of every array in the L1, L2 and L3 caches are
+	simulated for every row of parameter values, to validate the caches that
+	the working sets are placed in */
+	string fullFileName = userInput->inputFile
+		+ ExtractFileName(userInput->configFile) + "_sim_stats.csv";
+	ofstream file;
+	file.open(fullFileName);
+
+	if (file.is_open()) {
+		cout << "Writing to file " << fullFileName << endl;
+	}
+	else {
+		cout << "Could not open the file: " << fullFileName << endl;
+		exit(1);
+	}
+
+	file << "params,array,L1Hits,L1Misses,L2Hits,L2Misses,L3Hits,L3Misses"
+		<< endl;
+
+	vector<SimulatedArrayStats> arrayStats;
+	for (int j = 0; j < config->programParameterVector->size(); j++) {
+		unordered_map<string, int>* paramValues =
+			config->programParameterVector->at(j);
+		isl_set* context = ConstructContextEquatingParametersToConstants(
+			isl_set_get_space(scop->context), paramValues);
+
+		ProfileTimer* timer = StartProfileTimer("simulate");
+		bool isSimulated = SimulateCaches(scop, context, paramValues, config,
+			userInput->simulationSampling, &arrayStats);
+		StopProfileTimer(timer);
+		isl_set_free(context);
+
+		if (!isSimulated) {
+			cout << "The SCoP cannot be simulated" << endl;
+			break;
+		}
+
+		for (int i = 0; i < arrayStats.size(); i++) {
+			file << GetParameterValuesString(paramValues) << ","
+				<< arrayStats[i].array;
+			for (int level = 0; level < 3; level++) {
+				file << "," << arrayStats[i].hits[level] << ","
+					<< arrayStats[i].misses[level];
+			}
+
+			file << endl;
+		}
+	}
+
+	file.close();
+}
+
+isl_union_pw_qpolynomial* ComputeReusePairs(isl_union_map* reusedAccesses) {
+	/* The reused accesses to array A, as pairs of a statement instance and a
+	data unit, are the range of a map from the space A[], so that the count of
+	every array keeps its name */
+	isl_union_map* arrayAccesses = isl_union_map_empty(
+		isl_union_map_get_space(reusedAccesses));
+	isl_union_map_foreach_map(reusedAccesses, &AddArrayNameToAccesses,
+		&arrayAccesses);
+	isl_union_map_free(reusedAccesses);
+	return ComputeDataMapCard(arrayAccesses);
+}
+
+isl_stat AddArrayNameToAccesses(isl_map* accesses, void* user) {
+	isl_union_map** arrayAccesses = (isl_union_map**)user;
+	const char* name = isl_map_get_tuple_name(accesses, isl_dim_out);
+
+	if (name == NULL) {
+		isl_map_free(accesses);
+		return isl_stat_ok;
+	}
+
+	string arrayName = name;
+	isl_map* arrayAccessesMap = isl_map_set_tuple_name(
+		isl_map_from_range(isl_map_wrap(accesses)), isl_dim_in,
+		arrayName.c_str());
+	*arrayAccesses = isl_union_map_add_map(*arrayAccesses, arrayAccessesMap);
+	return isl_stat_ok;
+}
+
+void AddReuseDistances(map<string, map<int, double>>* histogram,
+	unordered_map<string, long>* reusePairs, long minBytes, long maxBytes) {
+	/* The reuse distances of the accesses that reuse the data of the source
+	of a dependence range from its smallest to its largest working set. The
+	accesses are spread evenly across the buckets in between. */
+	int minBucket = ComputeReuseDistanceBucket(minBytes);
+	int maxBucket = ComputeReuseDistanceBucket(maxBytes);
+	if (maxBucket < minBucket) {
+		swap(minBucket, maxBucket);
+	}
+
+	for (auto i : *reusePairs) {
+		double share = (double)i.second / (maxBucket - minBucket + 1);
+		for (int bucket = minBucket; bucket <= maxBucket; bucket++) {
+			(*histogram)[i.first][bucket] += share;
+		}
+	}
+}
+
+int ComputeReuseDistanceBucket(long bytes) {
+	/* Bucket k holds the reuse distances from 2^k to 2^(k + 1) - 1 bytes, and
+	bucket 0 those below 2 bytes */
+	int bucket = 0;
+	while (bucket < 62 && (1L << (bucket + 1)) <= bytes) {
+		bucket++;
+	}
+
+	return bucket;
+}
+
+void WriteReuseHistogramHeader(ostream& file, string prefixHeader) {
+	file << prefixHeader << "params,array,MinBytes,MaxBytes,Reuses" << endl;
+}
+
+void WriteReuseHistogram(ostream& file, string rowPrefix,
+	map<string, map<int, double>>* histogram) {
+	for (auto i : *histogram) {
+		for (auto j : i.second) {
+			long minBytes = j.first == 0 ? 0 : 1L << j.first;
+			long maxBytes = (1L << (j.first + 1)) - 1;
+			file << rowPrefix << "," << i.first << "," << minBytes << ","
+				<< maxBytes << "," << llround(j.second) << endl;
+		}
+	}
+}
+
+int ComputeActiveSockets(SystemConfig* systemConfig, long numThreads) {
+	/* The threads fill the hardware threads of a socket before the next one
+	when the cores of a socket are known, and are spread evenly across the
+	sockets otherwise */
+	if (systemConfig->numSockets <= 1 || numThreads <= 1) {
+		return 1;
+	}
+
+	if (systemConfig->coresPerSocket <= 0) {
+		return min((long)systemConfig->numSockets, numThreads);
+	}
+
+	long socketCapacity = (long)systemConfig->coresPerSocket
+		* max(systemConfig->L1SharingDegree, systemConfig->L2SharingDegree);
+	return min((long)systemConfig->numSockets,
+		(numThreads + socketCapacity - 1) / socketCapacity);
+}
+
+int ComputeSocketThreads(SystemConfig* systemConfig, long numThreads) {
+	/* The threads that share the L3 cache of a socket. The iterations of the
+	parallel loops are split across the sockets as they are across the
+	threads, in contiguous blocks under a static schedule. */
+	int numSockets = ComputeActiveSockets(systemConfig, numThreads);
+	return (numThreads + numSockets - 1) / numSockets;
+}
+
+long ComputeSocketWorkingSetSize(long size, int socketThreads, long numThreads,
+	bool isParallelLoopEncountered, long dataSetCommonCardInt) {
+	/* The share of a working set held by the L3 cache of one socket. A working
+	set that spans the iterations of the parallel loop holds the data of the
+	iterations of all the threads, of which a socket runs those of its own
+	threads. The data common to the iterations are held by every socket. */
+	if (!isParallelLoopEncountered || socketThreads >= numThreads
+		|| size <= 0) {
+		return size;
+	}
+
+	long commonSize = min(max(dataSetCommonCardInt, 0L), size);
+	return commonSize + (size - commonSize) * socketThreads / numThreads;
+}
+
+PolyScientistContext* CreatePolyScientistContext() {
+	PolyScientistContext* context = new PolyScientistContext;
+	context->ctx = isl_ctx_alloc_with_pet_options();
+	context->scop = NULL;
+	context->dependenceMap = NULL;
+	context->workingSetSizes = NULL;
+	return context;
+}
+
+void FreePolyScientistContext(PolyScientistContext* context) {
+	ClearPolyScientistContext(context);
+	isl_ctx_free(context->ctx);
+	delete context;
+}
+
+void ClearPolyScientistContext(PolyScientistContext* context) {
+	if (context->workingSetSizes) {
+		FreeWorkingSetSizes(context->workingSetSizes);
+		context->workingSetSizes = NULL;
+	}
+
+	if (context->dependenceMap) {
+		FreeDependenceMap(context->dependenceMap);
+		context->dependenceMap = NULL;
+	}
+
+	if (context->scop) {
+		FreeScop(context->scop);
+		context->scop = NULL;
+	}
+
+	context->source.clear();
+	context->dependencesKey.clear();
+	context->workingSetSizesKey.clear();
+}
+
+bool AnalyzeDataReuse(PolyScientistContext* context, UserInput* options,
+	SystemConfig* systemConfig,
+	vector<unordered_map<string, int>>* paramValues,
+	vector<DataSetSizes>* sizes) {
+	/* The options are checked before they are read, since reading invalid
+	options quits as on the command line */
+	if ((options->inputFile.empty() && options->loadScop.empty()) ||
+		options->datatypesize.empty() ||
+		!AreConfigOptionsValid(options, systemConfig)) {
+		return false;
+	}
+
+	/* The analysis is kept in the context rather than in --cache-dir, and is
+	not reported on stdout */
+	UserInput contextOptions = *options;
+	contextOptions.cacheDir.clear();
+	contextOptions.quiet = true;
+	options = &contextOptions;
+
+	/* The dependences and the working sets are computed without parameter
+	values, so that they are reused across the calls for any parameter values.
+	The parameter values are added for the evaluation only. */
+	Config* config = new Config;
+	ReadConfig(options, systemConfig, config);
+
+	string source = options->loadScop.empty() ? "source " + options->inputFile :
+		"snapshot " + options->loadScop;
+	string snapshotDependencesKey;
+	vector<string> snapshotDependences;
+	if (context->scop == NULL || context->source != source) {
+		ClearPolyScientistContext(context);
+		if (!options->loadScop.empty()) {
+			context->scop = LoadScop(context->ctx, options,
+				&snapshotDependencesKey, &snapshotDependences);
+		}
+		else {
+			lock_guard<mutex> lock(parseScopMutex);
+			context->scop = ParseScop(context->ctx, options->inputFile.c_str());
+		}
+
+		if (context->scop == NULL) {
+			FreeConfig(config);
+			return false;
+		}
+
+		context->source = source;
+	}
+
+	if (!AreParameterValuesGiven(context->scop, paramValues)) {
+		FreeConfig(config);
+		return false;
+	}
+
+	string dependencesKey = GetDependencesCacheKey(options, context->scop,
+		config);
+	if (context->dependenceMap == NULL ||
+		context->dependencesKey != dependencesKey) {
+		if (context->workingSetSizes) {
+			FreeWorkingSetSizes(context->workingSetSizes);
+			context->workingSetSizes = NULL;
+		}
+
+		if (context->dependenceMap) {
+			FreeDependenceMap(context->dependenceMap);
+			context->dependenceMap = NULL;
+		}
+
+		if (!snapshotDependences.empty() &&
+			snapshotDependencesKey == dependencesKey) {
+			context->dependenceMap = DeserializeDependenceMap(context->ctx,
+				&snapshotDependences);
+		}
+
+		if (context->dependenceMap == NULL) {
+			context->dependenceMap = ComputeDataDependences(options, context->ctx,
+				context->scop, config);
+		}
+
+		context->dependencesKey = dependencesKey;
+	}
+
+	if (context->dependenceMap->size() == 0) {
+		FreeConfig(config);
+		return false;
+	}
+
+	isl_union_map* schedule = ComputePaddedScheduleMap(context->scop);
+	string workingSetSizesKey = GetWorkingSetSizesCacheKey(
+		context->dependenceMap, schedule, config);
+	if (schedule) {
+		isl_union_map_free(schedule);
+	}
+
+	if (context->workingSetSizes == NULL ||
+		context->workingSetSizesKey != workingSetSizesKey) {
+		if (context->workingSetSizes) {
+			FreeWorkingSetSizes(context->workingSetSizes);
+		}
+
+		context->workingSetSizes = ComputeWorkingSetSizesForDependences(options,
+			context->dependenceMap, context->scop, config);
+		context->workingSetSizesKey = workingSetSizesKey;
+	}
+
+	for (int i = 0; i < paramValues->size(); i++) {
+		config->programParameterVector->push_back(
+			new unordered_map<string, int>(paramValues->at(i)));
+	}
+
+	/* The rows of the statistics are not written anywhere */
+	ostringstream stats;
+	SimplifyWorkingSetSizes(context->workingSetSizes, options, config,
+		context->scop, stats, "", NULL, NULL, NULL, sizes);
+	FreeConfig(config);
+	return true;
+}
+
+bool AreParameterValuesGiven(Scop* scop,
+	vector<unordered_map<string, int>>* paramValues) {
+	/* The evaluation of the working sets quits on a parameter of the scop
+	whose value is not given */
+	isl_size numParams = isl_set_dim(scop->context, isl_dim_param);
+	for (int i = 0; i < paramValues->size(); i++) {
+		for (int j = 0; j < numParams; j++) {
+			const char* name = isl_set_get_dim_name(scop->context,
+				isl_dim_param, j);
+			if (name == NULL ||
+				paramValues->at(i).find(name) == paramValues->at(i).end()) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -1,6 +1,10 @@
 #include <OptionsProcessor.hpp>
 #include <stdlib.h>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
 using namespace std;
 
 void ReadUserInput(int argc, char **argv, UserInput *userInput) {
@@ -11,6 +15,7 @@ void ReadUserInput(int argc, char **argv, UserInput *userInput) {
 	./polyscientist --input conv2d.c --config conv2d_config
 	*/
 	string inputPrefix = "--input";
+	string inputListPrefix = "--input-list";
 	string configPrefix = "--config";
 	string diagnostic = "--diagnostic";
 	string minimalOutput = "--minout";
@@ -21,17 +26,37 @@ void ReadUserInput(int argc, char **argv, UserInput *userInput) {
 	string parallelLoops = "--parallel_loops";
 	string numProcs = "--numprocs";
 	string sharedcaches = "--sharedcaches";
+	string numJobs = "--jobs";
+	string cacheDir = "--cache-dir";
+	string benchmarkEvaluator = "--benchmark-evaluator";
+	string emitEvaluator = "--emit-evaluator";
+	string profile = "--profile";
+	string cacheLines = "--cachelines";
+	string tlb = "--tlb";
+	string detectCaches = "--detect-caches";
+	string arrayStats = "--array-stats";
+	string dependenceTimeout = "--dependence-timeout";
+	string traffic = "--traffic";
+	string dependenceMaxOperations = "--dependence-max-ops";
+	string machine = "--machine";
+	string roofline = "--roofline";
+	string simulate = "--simulate";
+	string simulationSampling = "--simulate-sample";
+	string reuseHistogram = "--reuse-histogram";
+	string saveScop = "--save-scop";
+	string loadScop = "--load-scop";
 
-	userInput->interactive = false;
-	userInput->minOutput = false;
-	userInput->perarray = false;
-	userInput->numProcs = 1;
+	InitializeUserInput(userInput);
 
 	for (i = 1; i < argc;) {
 		if (argv[i] == inputPrefix) {
 			userInput->inputFile = argv[i + 1];
 			i += 2;
 		}
+		else if (argv[i] == inputListPrefix) {
+			userInput->inputList = argv[i + 1];
+			i += 2;
+		}
 		else if (argv[i] == configPrefix) {
 			userInput->configFile = argv[i + 1];
 			i += 2;
@@ -78,18 +103,150 @@ void ReadUserInput(int argc, char **argv, UserInput *userInput) {
 			userInput->sharedcaches = argv[i + 1];
 			i += 2;
 		}
+		else if (argv[i] == benchmarkEvaluator) {
+			userInput->benchmarkEvaluator = true;
+			i++;
+		}
+		else if (argv[i] == emitEvaluator) {
+			userInput->emitEvaluator = true;
+			i++;
+		}
+		else if (argv[i] == profile) {
+			userInput->profile = true;
+			i++;
+		}
+		else if (argv[i] == cacheLines) {
+			userInput->cacheLines = true;
+			i++;
+		}
+		else if (argv[i] == tlb) {
+			userInput->tlb = true;
+			i++;
+		}
+		else if (argv[i] == detectCaches) {
+			userInput->detectCaches = true;
+			i++;
+		}
+		else if (argv[i] == arrayStats) {
+			userInput->arrayStats = true;
+			i++;
+		}
+		else if (argv[i] == traffic) {
+			userInput->traffic = true;
+			i++;
+		}
+		else if (argv[i] == roofline) {
+			userInput->roofline = true;
+			i++;
+		}
+		else if (argv[i] == simulate) {
+			userInput->simulate = true;
+			i++;
+		}
+		else if (argv[i] == simulationSampling) {
+			userInput->simulate = true;
+			userInput->simulationSampling = atoi(argv[i + 1]);
+			i += 2;
+
+			if (userInput->simulationSampling <= 0) {
+				cout << "The sampling of the simulation has to greater than zero. The entered value is: " <<
+					userInput->simulationSampling << " Quitting. " << endl;
+				exit(1);
+			}
+		}
+		else if (argv[i] == reuseHistogram) {
+			userInput->reuseHistogram = true;
+			i++;
+		}
+		else if (argv[i] == saveScop) {
+			userInput->saveScop = argv[i + 1];
+			i += 2;
+		}
+		else if (argv[i] == loadScop) {
+			userInput->loadScop = argv[i + 1];
+			i += 2;
+		}
+		else if (argv[i] == machine) {
+			userInput->machine = argv[i + 1];
+			i += 2;
+		}
+		else if (argv[i] == dependenceTimeout) {
+			userInput->dependenceTimeout = atof(argv[i + 1]);
+			i += 2;
+
+			if (userInput->dependenceTimeout <= 0) {
+				cout << "The time budget of a dependence has to greater than zero. The entered value is: " <<
+					userInput->dependenceTimeout << " Quitting. " << endl;
+				exit(1);
+			}
+		}
+		else if (argv[i] == dependenceMaxOperations) {
+			userInput->dependenceMaxOperations = strtoul(argv[i + 1], NULL, 10);
+			i += 2;
+
+			if (userInput->dependenceMaxOperations == 0) {
+				cout << "The operations budget of a dependence has to greater than zero. The entered value is: " <<
+					argv[i - 1] << " Quitting. " << endl;
+				exit(1);
+			}
+		}
+		else if (argv[i] == cacheDir) {
+			userInput->cacheDir = argv[i + 1];
+			i += 2;
+		}
+		else if (argv[i] == numJobs) {
+			userInput->numJobs = atoi(argv[i + 1]);
+			i += 2;
+
+			if (userInput->numJobs <= 0) {
+				cout << "The number of jobs has to greater than zero. The entered value is: " <<
+					userInput->numJobs << " Quitting. " << endl;
+				exit(1);
+			}
+		}
 		else {
 			printf("Unexpected command line input: %s. Exiting\n", argv[i]);
 			exit(1);
 		}
 	}
 
-	if (userInput->inputFile.empty()) {
+	if (!userInput->inputList.empty()) {
+		if (!userInput->inputFile.empty()) {
+			printf("Both an input file and an input list are specified. Exiting\n");
+			exit(1);
+		}
+
+		if (userInput->interactive) {
+			printf("An input list cannot be analyzed in the diagnostic mode. Exiting\n");
+			exit(1);
+		}
+
+		if (userInput->simulate) {
+			printf("An input list cannot be simulated. Exiting\n");
+			exit(1);
+		}
+
+		if (!userInput->saveScop.empty() || !userInput->loadScop.empty()) {
+			printf("An input list cannot be saved to or loaded from a scop snapshot. Exiting\n");
+			exit(1);
+		}
+
+		cout << "Input list: " << userInput->inputList << endl;
+	}
+	else if (userInput->inputFile.empty() && !userInput->loadScop.empty()) {
+		/* The output files are named after the snapshot */
+		userInput->inputFile = userInput->loadScop;
+		cout << "Scop snapshot: " << userInput->loadScop << endl;
+	}
+	else if (userInput->inputFile.empty()) {
 		printf("Input file not specified. Exiting\n");
 		exit(1);
 	}
 	else {
 		cout << "Input file: " << userInput->inputFile << endl;
+		if (!userInput->loadScop.empty()) {
+			cout << "Scop snapshot: " << userInput->loadScop << endl;
+		}
 	}
 
 	if (userInput->configFile.empty()
@@ -110,4 +267,91 @@ void ReadUserInput(int argc, char **argv, UserInput *userInput) {
 			<< "The number of processors must be greater than 1. Quitting" << endl;
 		exit(1);
 	}
-}
\ No newline at end of file
+}
+
+void InitializeUserInput(UserInput *userInput) {
+	userInput->interactive = false;
+	userInput->minOutput = false;
+	userInput->perarray = false;
+	userInput->benchmarkEvaluator = false;
+	userInput->emitEvaluator = false;
+	userInput->profile = false;
+	userInput->cacheLines = false;
+	userInput->tlb = false;
+	userInput->detectCaches = false;
+	userInput->arrayStats = false;
+	userInput->traffic = false;
+	userInput->roofline = false;
+	userInput->simulate = false;
+	userInput->simulationSampling = 1;
+	userInput->reuseHistogram = false;
+	userInput->quiet = false;
+	userInput->dependenceTimeout = 0;
+	userInput->dependenceMaxOperations = 0;
+	userInput->numProcs = 1;
+	userInput->numJobs = 1;
+}
+
+void ReadInputList(string inputList, vector<string> *inputFiles) {
+	/* The input list is either a directory, in which case all the .c files in
+	it are analyzed in the alphabetical order, except the evaluators written by
+	--emit-evaluator, or a manifest file that lists one source file per line.
+	Empty lines and lines starting with # are skipped. */
+	struct stat pathStat;
+	if (stat(inputList.c_str(), &pathStat) != 0) {
+		cout << "Unable to open the input list: " << inputList << endl;
+		exit(1);
+	}
+
+	if (S_ISDIR(pathStat.st_mode)) {
+		DIR *dir = opendir(inputList.c_str());
+		if (dir == NULL) {
+			cout << "Unable to open the input directory: " << inputList << endl;
+			exit(1);
+		}
+
+		string suffix = ".c";
+		string evaluatorSuffix = "_evaluator.c";
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != NULL) {
+			string name = entry->d_name;
+			if (name.size() > suffix.size() &&
+				name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+				!(name.size() > evaluatorSuffix.size() &&
+					name.compare(name.size() - evaluatorSuffix.size(),
+						evaluatorSuffix.size(), evaluatorSuffix) == 0)) {
+				inputFiles->push_back(inputList + "/" + name);
+			}
+		}
+
+		closedir(dir);
+		sort(inputFiles->begin(), inputFiles->end());
+	}
+	else {
+		ifstream inFile;
+		inFile.open(inputList);
+
+		if (!inFile) {
+			cout << "Unable to open the input list: " << inputList << endl;
+			exit(1);
+		}
+
+		string line;
+		while (getline(inFile, line)) {
+			size_t begin = line.find_first_not_of(" \t\r");
+			if (begin == string::npos || line[begin] == '#') {
+				continue;
+			}
+
+			size_t end = line.find_last_not_of(" \t\r");
+			inputFiles->push_back(line.substr(begin, end - begin + 1));
+		}
+
+		inFile.close();
+	}
+
+	if (inputFiles->empty()) {
+		cout << "No input files found in the input list: " << inputList << endl;
+		exit(1);
+	}
+}
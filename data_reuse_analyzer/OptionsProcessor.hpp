@@ -2,23 +2,47 @@
 #define OPTIONS_PROCESSOR_HPP
 
 #include <string>
+#include <vector>
 
 struct UserInput {
 	std::string inputFile;
+	std::string inputList;
 	std::string configFile;
 	std::string parameters;
 	std::string cachesizes;
 	std::string datatypesize;
 	std::string parallelLoops;
 	std::string sharedcaches;
+	std::string cacheDir;
+	std::string machine;
+	std::string saveScop;
+	std::string loadScop;
 	int numProcs;
+	int numJobs;
+	int simulationSampling; // every how many iterations of an outer loop are simulated
+	double dependenceTimeout; // in seconds, zero for no limit
+	unsigned long dependenceMaxOperations; // zero for no limit
 	bool interactive;
 	bool minOutput;
 	bool perarray;
+	bool benchmarkEvaluator;
+	bool emitEvaluator;
+	bool profile;
+	bool cacheLines;
+	bool tlb;
+	bool detectCaches;
+	bool arrayStats;
+	bool traffic;
+	bool roofline;
+	bool simulate;
+	bool reuseHistogram;
+	bool quiet; // no reports of the progress of the analysis on stdout
 };
 
 typedef struct UserInput UserInput;
+void InitializeUserInput(UserInput *userInput);
 void ReadUserInput(int argc, char **argv, UserInput *userInput);
+void ReadInputList(std::string inputList, std::vector<std::string> *inputFiles);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef POLYSCIENTIST_HPP
+#define POLYSCIENTIST_HPP
+
+#include <ConfigProcessor.hpp>
+#include <OptionsProcessor.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/* The data set sizes, in bytes, of the working sets placed in the L1, L2 and
+L3 caches and in the memory for one row of parameter values, i.e., the
+L1DataSetSize to MemDataSetSize columns of <input><config>_ws_stats.csv */
+struct DataSetSizes {
+	std::unordered_map<std::string, int> paramValues;
+	long L1;
+	long L2;
+	long L3;
+	long Mem;
+	/* Whether a dependence of the data sets exceeded its budget and has its
+	data sets bounded instead of counted */
+	bool approximate;
+};
+
+typedef struct DataSetSizes DataSetSizes;
+
+/* The isl context of an analysis, with the scop last analyzed in it and its
+dependences and working sets. isl objects cannot be shared across threads, so
+that a context is used by one thread at a time, while any number of contexts
+may be used concurrently. */
+struct PolyScientistContext;
+
+typedef struct PolyScientistContext PolyScientistContext;
+
+PolyScientistContext* CreatePolyScientistContext();
+void FreePolyScientistContext(PolyScientistContext* context);
+
+/* Computes the data set sizes of the scop of options->inputFile, or of the scop
+snapshot options->loadScop, on the machine systemConfig, for every row of
+parameter values. The other options are those of the command line, e.g.,
+options->datatypesize, options->parallelLoops and options->numProcs, and are
+initialized by InitializeUserInput(). No file is written. The scop, the
+dependences and the working sets are kept in the context and are reused by the
+next call for the same source as long as the options they depend on are the
+same, so that only the evaluation of the working sets is repeated for other
+caches and parameter values. Nothing is printed on stdout. Returns false when
+the source has no scop or no dependences, when the options are invalid, e.g.,
+the numbers of threads of options->parallelLoops do not multiply to
+options->numProcs, or when a row lacks the value of a parameter of the scop. */
+bool AnalyzeDataReuse(PolyScientistContext* context, UserInput* options,
+	SystemConfig* systemConfig,
+	std::vector<std::unordered_map<std::string, int>>* paramValues,
+	std::vector<DataSetSizes>* sizes);
+
+/* Runs the analysis of the command line arguments, as polyscientist does */
+void OrchestrateDataReuseComputation(int argc, char **argv);
+
+#endif
@@ -0,0 +1,118 @@
+#include <PolynomialEvaluator.hpp>
+#include <isl/val.h>
+#include <isl/point.h>
+#include <algorithm>
+using namespace std;
+
+struct PolynomialEvaluation {
+	ParameterBinding* binding;
+	isl_val* value;
+	int numPieces;
+	bool isEvaluated;
+};
+
+typedef struct PolynomialEvaluation PolynomialEvaluation;
+
+isl_stat EvaluatePwQpolynomial(isl_pw_qpolynomial *pwqp, void *user);
+
+ParameterBinding* BindParameterValues(isl_ctx* ctx,
+	unordered_map<string, int>* paramValues) {
+	/* The parameters are sorted by their names so that the binding does not
+	depend on the iteration order of the map */
+	vector<string> names;
+	for (auto i : *paramValues) {
+		names.push_back(i.first);
+	}
+
+	sort(names.begin(), names.end());
+
+	ParameterBinding* binding = new ParameterBinding;
+	binding->paramSpace = isl_space_params_alloc(ctx, names.size());
+	binding->values = new vector<long>();
+
+	for (int i = 0; i < names.size(); i++) {
+		binding->paramSpace = isl_space_set_dim_name(binding->paramSpace,
+			isl_dim_param, i, names[i].c_str());
+		binding->values->push_back(paramValues->at(names[i]));
+	}
+
+	return binding;
+}
+
+void FreeParameterBinding(ParameterBinding* binding) {
+	isl_space_free(binding->paramSpace);
+	delete binding->values;
+	delete binding;
+}
+
+bool EvaluateUnionPwQpolynomial(isl_union_pw_qpolynomial* polynomial,
+	ParameterBinding* binding, long* value) {
+	/* The working set sizes are cardinalities of parametric sets. Therefore,
+	every piecewise quasi-polynomial is defined over the parameters alone and is
+	evaluated at the point given by the bound parameter values. A polynomial
+	over set dimensions or over an unbound parameter cannot be evaluated and
+	false is returned. */
+	PolynomialEvaluation* evaluation = new PolynomialEvaluation;
+	evaluation->binding = binding;
+	evaluation->value = isl_val_zero(
+		isl_union_pw_qpolynomial_get_ctx(polynomial));
+	evaluation->numPieces = 0;
+	evaluation->isEvaluated = true;
+
+	if (isl_union_pw_qpolynomial_foreach_pw_qpolynomial(polynomial,
+		&EvaluatePwQpolynomial, evaluation) < 0) {
+		evaluation->isEvaluated = false;
+	}
+
+	/* An empty polynomial has no value. This is consistent with
+	ExtractIntegerFromUnionPwQpolynomial(). */
+	bool isEvaluated = evaluation->isEvaluated && evaluation->numPieces > 0 &&
+		evaluation->value &&
+		isl_val_is_rat(evaluation->value);
+	if (isEvaluated) {
+		/* The cardinalities are integral at integer points. A rational value
+		can only result from a quasi-polynomial with a rounding error and is
+		rounded down. */
+		evaluation->value = isl_val_floor(evaluation->value);
+		*value = isl_val_get_num_si(evaluation->value);
+	}
+
+	isl_val_free(evaluation->value);
+	delete evaluation;
+	return isEvaluated;
+}
+
+isl_stat EvaluatePwQpolynomial(isl_pw_qpolynomial *pwqp, void *user) {
+	PolynomialEvaluation* evaluation = (PolynomialEvaluation*)user;
+	ParameterBinding* binding = evaluation->binding;
+
+	if (isl_pw_qpolynomial_dim(pwqp, isl_dim_in) != 0) {
+		isl_pw_qpolynomial_free(pwqp);
+		return isl_stat_error;
+	}
+
+	pwqp = isl_pw_qpolynomial_align_params(pwqp,
+		isl_space_copy(binding->paramSpace));
+	if (isl_pw_qpolynomial_dim(pwqp, isl_dim_param) != binding->values->size()) {
+		isl_pw_qpolynomial_free(pwqp);
+		return isl_stat_error;
+	}
+
+	/* After the alignment the parameters of the polynomial are in the order
+	of the binding */
+	isl_point* point = isl_point_zero(isl_pw_qpolynomial_get_domain_space(pwqp));
+	for (int i = 0; i < binding->values->size(); i++) {
+		point = isl_point_set_coordinate_val(point, isl_dim_param, i,
+			isl_val_int_from_si(isl_pw_qpolynomial_get_ctx(pwqp),
+				binding->values->at(i)));
+	}
+
+	isl_val* value = isl_pw_qpolynomial_eval(pwqp, point);
+	if (!value) {
+		return isl_stat_error;
+	}
+
+	evaluation->value = isl_val_add(evaluation->value, value);
+	evaluation->numPieces++;
+	return isl_stat_ok;
+}
@@ -0,0 +1,26 @@
+#ifndef POLYNOMIAL_EVALUATOR_HPP
+#define POLYNOMIAL_EVALUATOR_HPP
+
+#include <isl/space.h>
+#include <barvinok/isl.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/* The values of the program parameters of one row of the config file, bound
+to a parameter space once so that any number of polynomials can be evaluated
+with them without printing or gisting the polynomials. */
+struct ParameterBinding {
+	isl_space* paramSpace;
+	std::vector<long>* values;
+};
+
+typedef struct ParameterBinding ParameterBinding;
+
+ParameterBinding* BindParameterValues(isl_ctx* ctx,
+	std::unordered_map<std::string, int>* paramValues);
+void FreeParameterBinding(ParameterBinding* binding);
+bool EvaluateUnionPwQpolynomial(isl_union_pw_qpolynomial* polynomial,
+	ParameterBinding* binding, long* value);
+
+#endif
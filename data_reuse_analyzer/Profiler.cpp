@@ -0,0 +1,182 @@
+#include <Profiler.hpp>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <sys/resource.h>
+using namespace std;
+
+struct ProfileRecord {
+	string input;
+	string phase;
+	string item;
+	long calls;
+	double wallTime;
+	double maxWallTime;
+	long peakRss;
+	long peakRssGrowth;
+};
+
+typedef struct ProfileRecord ProfileRecord;
+
+long GetPeakRss();
+string QuoteCsvField(string field);
+
+bool profilingEnabled = false;
+mutex profileMutex;
+/* The records in the order in which they were first seen, and indexed by
+their input, phase and item */
+vector<ProfileRecord*> profileRecords;
+unordered_map<string, ProfileRecord*> profileRecordIndex;
+/* The input file analyzed by the current thread. It is empty in the threads
+that analyze the dependences of a single input file. */
+thread_local string profileInput;
+
+void EnableProfiling() {
+	profilingEnabled = true;
+}
+
+bool IsProfilingEnabled() {
+	return profilingEnabled;
+}
+
+void SetProfileInput(string inputFile) {
+	profileInput = inputFile;
+}
+
+ProfileTimer* StartProfileTimer(string phase) {
+	return StartProfileTimer(phase, "");
+}
+
+ProfileTimer* StartProfileTimer(string phase, string item) {
+	if (!profilingEnabled) {
+		return NULL;
+	}
+
+	ProfileTimer* timer = new ProfileTimer;
+	timer->phase = phase;
+	timer->item = item;
+	timer->input = profileInput;
+	timer->begin = chrono::steady_clock::now();
+	timer->beginPeakRss = GetPeakRss();
+	return timer;
+}
+
+void StopProfileTimer(ProfileTimer* timer) {
+	if (timer == NULL) {
+		return;
+	}
+
+	double wallTime = chrono::duration<double>(
+		chrono::steady_clock::now() - timer->begin).count();
+	long peakRss = GetPeakRss();
+	/* The peak of the process only grows. Therefore a call is charged with
+	the growth of the peak while it runs, which is zero unless it sets a new
+	peak. */
+	long peakRssGrowth = -1;
+	if (peakRss != -1 && timer->beginPeakRss != -1) {
+		peakRssGrowth = peakRss - timer->beginPeakRss;
+	}
+
+	string key = timer->input + '\0' + timer->phase + '\0' + timer->item;
+
+	{
+		lock_guard<mutex> lock(profileMutex);
+		ProfileRecord* record = NULL;
+		auto it = profileRecordIndex.find(key);
+		if (it == profileRecordIndex.end()) {
+			record = new ProfileRecord;
+			record->input = timer->input;
+			record->phase = timer->phase;
+			record->item = timer->item;
+			record->calls = 0;
+			record->wallTime = 0;
+			record->maxWallTime = 0;
+			record->peakRss = 0;
+			record->peakRssGrowth = 0;
+			profileRecords.push_back(record);
+			profileRecordIndex[key] = record;
+		}
+		else {
+			record = it->second;
+		}
+
+		record->calls++;
+		record->wallTime += wallTime;
+		record->maxWallTime = max(record->maxWallTime, wallTime);
+		record->peakRss = max(record->peakRss, peakRss);
+		record->peakRssGrowth = max(record->peakRssGrowth, peakRssGrowth);
+	}
+
+	delete timer;
+}
+
+void WriteProfile(string fileName, string defaultInput) {
+	/* The peak resident set size is the one of the process at the end of the
+	calls, and its growth the largest growth of that peak during one call, in
+	kilobytes. The records are consumed. */
+	if (!profilingEnabled) {
+		return;
+	}
+
+	ofstream file;
+	file.open(fileName);
+
+	if (file.is_open()) {
+		cout << "Writing the profile to file " << fileName << endl;
+	}
+	else {
+		cout << "Could not open the file: " << fileName << endl;
+		exit(1);
+	}
+
+	lock_guard<mutex> lock(profileMutex);
+	file << "input,phase,item,calls,wall_time_s,max_wall_time_s,peak_rss_kb"
+		<< ",peak_rss_growth_kb" << endl;
+	file << fixed << setprecision(6);
+	for (int i = 0; i < profileRecords.size(); i++) {
+		ProfileRecord* record = profileRecords[i];
+		string input = record->input.empty() ? defaultInput : record->input;
+		file << QuoteCsvField(input) << ","
+			<< record->phase << ","
+			<< QuoteCsvField(record->item) << ","
+			<< record->calls << ","
+			<< record->wallTime << ","
+			<< record->maxWallTime << ","
+			<< record->peakRss << ","
+			<< record->peakRssGrowth << endl;
+		delete record;
+	}
+
+	file.close();
+	profileRecords.clear();
+	profileRecordIndex.clear();
+}
+
+long GetPeakRss() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+
+	return usage.ru_maxrss;
+}
+
+string QuoteCsvField(string field) {
+	if (field.find_first_of(",\"\n") == string::npos) {
+		return field;
+	}
+
+	string quoted = "\"";
+	for (int i = 0; i < field.size(); i++) {
+		if (field[i] == '"') {
+			quoted += '"';
+		}
+
+		quoted += field[i];
+	}
+
+	return quoted + "\"";
+}
@@ -0,0 +1,28 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <chrono>
+
+/* Records the wall time, the number of calls and the peak resident set size
+of the phases of an analysis, e.g., parsing the SCoP or counting a set, and of
+every dependence. The timers are no-ops unless profiling is enabled. */
+struct ProfileTimer {
+	std::string phase;
+	std::string item;
+	std::string input;
+	std::chrono::steady_clock::time_point begin;
+	long beginPeakRss;
+};
+
+typedef struct ProfileTimer ProfileTimer;
+
+void EnableProfiling();
+bool IsProfilingEnabled();
+void SetProfileInput(std::string inputFile);
+ProfileTimer* StartProfileTimer(std::string phase);
+ProfileTimer* StartProfileTimer(std::string phase, std::string item);
+void StopProfileTimer(ProfileTimer* timer);
+void WriteProfile(std::string fileName, std::string defaultInput);
+
+#endif
@@ -0,0 +1,102 @@
+#include <Scop.hpp>
+using namespace std;
+
+Scop* AllocateScop() {
+	Scop* scop = new Scop;
+	scop->context = NULL;
+	scop->schedule = NULL;
+	scop->mayReads = NULL;
+	scop->mayWrites = NULL;
+	scop->arrayExtents = new vector<isl_set*>();
+	scop->statements = new vector<ScopStatement>();
+	return scop;
+}
+
+Scop* ExtractScop(pet_scop* petScop) {
+	if (petScop == NULL) {
+		return NULL;
+	}
+
+	Scop* scop = AllocateScop();
+	scop->context = isl_set_copy(petScop->context);
+	scop->schedule = pet_scop_get_schedule(petScop);
+	scop->mayReads = pet_scop_get_may_reads(petScop);
+	scop->mayWrites = pet_scop_get_may_writes(petScop);
+
+	for (int i = 0; i < petScop->n_array; i++) {
+		if (petScop->arrays[i]->extent) {
+			scop->arrayExtents->push_back(
+				isl_set_copy(petScop->arrays[i]->extent));
+		}
+	}
+
+	for (int i = 0; i < petScop->n_stmt; i++) {
+		ScopStatement statement;
+		statement.domain = isl_set_copy(petScop->stmts[i]->domain);
+		statement.flops = CountStatementFlops(petScop->stmts[i]->body);
+		scop->statements->push_back(statement);
+	}
+
+	return scop;
+}
+
+void FreeScop(Scop* scop) {
+	if (scop == NULL) {
+		return;
+	}
+
+	isl_set_free(scop->context);
+	isl_schedule_free(scop->schedule);
+	isl_union_map_free(scop->mayReads);
+	isl_union_map_free(scop->mayWrites);
+
+	for (int i = 0; i < scop->arrayExtents->size(); i++) {
+		isl_set_free(scop->arrayExtents->at(i));
+	}
+
+	for (int i = 0; i < scop->statements->size(); i++) {
+		isl_set_free(scop->statements->at(i).domain);
+	}
+
+	delete scop->arrayExtents;
+	delete scop->statements;
+	delete scop;
+}
+
+int CountStatementFlops(pet_tree* body) {
+	int flops = 0;
+	pet_tree_foreach_expr(body, AddExprFlops, &flops);
+	return flops;
+}
+
+int AddExprFlops(pet_expr* expr, void* user) {
+	/* A flop is an addition, a subtraction, a multiplication or a division,
+	also as a compound assignment. The index expressions of the accesses are
+	not a part of the expression tree, so that only the arithmetic on the data
+	is counted. */
+	int* flops = (int*)user;
+	if (pet_expr_get_type(expr) == pet_expr_op) {
+		switch (pet_expr_op_get_type(expr)) {
+		case pet_op_add_assign:
+		case pet_op_sub_assign:
+		case pet_op_mul_assign:
+		case pet_op_div_assign:
+		case pet_op_add:
+		case pet_op_sub:
+		case pet_op_mul:
+		case pet_op_div:
+			(*flops)++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	for (int i = 0; i < pet_expr_get_n_arg(expr); i++) {
+		pet_expr* arg = pet_expr_get_arg(expr, i);
+		AddExprFlops(arg, user);
+		pet_expr_free(arg);
+	}
+
+	return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef SCOP_HPP
+#define SCOP_HPP
+
+#include <pet.h>
+#include <isl/set.h>
+#include <isl/union_map.h>
+#include <isl/schedule.h>
+#include <vector>
+
+/* A statement of a scop: the set of its instances and the number of flops of
+one instance */
+struct ScopStatement {
+	isl_set* domain;
+	int flops;
+};
+
+typedef struct ScopStatement ScopStatement;
+
+/* The parts of a scop that the analysis reads. They are extracted from the
+scop of pet, or read from a scop snapshot, which does not need the front end. */
+struct Scop {
+	isl_set* context;
+	isl_schedule* schedule;
+	isl_union_map* mayReads;
+	isl_union_map* mayWrites;
+	std::vector<isl_set*>* arrayExtents;
+	std::vector<ScopStatement>* statements;
+};
+
+typedef struct Scop Scop;
+
+Scop* AllocateScop();
+Scop* ExtractScop(pet_scop* petScop);
+void FreeScop(Scop* scop);
+int CountStatementFlops(pet_tree* body);
+int AddExprFlops(pet_expr* expr, void* user);
+
+#endif
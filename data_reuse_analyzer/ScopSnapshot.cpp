@@ -0,0 +1,186 @@
+#include <ScopSnapshot.hpp>
+#include <AnalysisCache.hpp>
+#include <Utility.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+using namespace std;
+
+#define SCOP_SNAPSHOT_VERSION "polyscientist-scop-v2"
+
+Scop* ParseScopRecords(isl_ctx* ctx, vector<string>* records, int* next);
+bool ParseRecordCount(vector<string>* records, int* next, int* count);
+
+bool WriteScopSnapshot(string fileName, Scop* scop, string dependencesKey,
+	vector<string>* dependenceRecords) {
+	/* The snapshot is of the form:
+	<version>
+	<context>
+	<schedule>
+	<may reads>
+	<may writes>
+	<number of arrays> <extent of every array>
+	<number of statements> <domain and flops of every statement>
+	<key of the dependences>
+	<dependence records>
+	in the format of the entries of the analysis cache. The parts of the scop
+	are written in the textual form of isl. */
+	vector<string> records;
+	records.push_back(SCOP_SNAPSHOT_VERSION);
+	records.push_back(SetToString(scop->context));
+	records.push_back(ScheduleToString(scop->schedule));
+	records.push_back(UnionMapToString(scop->mayReads));
+	records.push_back(UnionMapToString(scop->mayWrites));
+
+	records.push_back(to_string(scop->arrayExtents->size()));
+	for (int i = 0; i < scop->arrayExtents->size(); i++) {
+		records.push_back(SetToString(scop->arrayExtents->at(i)));
+	}
+
+	records.push_back(to_string(scop->statements->size()));
+	for (int i = 0; i < scop->statements->size(); i++) {
+		records.push_back(SetToString(scop->statements->at(i).domain));
+		records.push_back(to_string(scop->statements->at(i).flops));
+	}
+
+	records.push_back(dependencesKey);
+	records.insert(records.end(), dependenceRecords->begin(),
+		dependenceRecords->end());
+
+	ofstream file;
+	file.open(fileName, ios::out | ios::binary);
+	if (!file.is_open()) {
+		cout << "Could not open the file: " << fileName << endl;
+		return false;
+	}
+
+	WriteAnalysisRecords(file, &records);
+	file.close();
+	cout << "Writing to file " << fileName << endl;
+	return true;
+}
+
+Scop* ReadScopSnapshot(isl_ctx* ctx, string fileName, bool quiet,
+	string* dependencesKey, vector<string>* dependenceRecords) {
+	/* Nothing is printed on stdout if quiet */
+	ifstream file;
+	file.open(fileName, ios::in | ios::binary);
+	if (!file) {
+		if (!quiet) {
+			cout << "Unable to open the scop snapshot: " << fileName << endl;
+		}
+
+		return NULL;
+	}
+
+	vector<string> records;
+	if (!ReadAnalysisRecords(file, &records) || records.empty()) {
+		if (!quiet) {
+			cout << "The scop snapshot is corrupt: " << fileName << endl;
+		}
+
+		return NULL;
+	}
+
+	file.close();
+
+	if (records[0] != SCOP_SNAPSHOT_VERSION) {
+		if (!quiet) {
+			cout << "The scop snapshot " << fileName << " was written by "
+				<< "another version of polyscientist: " << records[0] << endl;
+		}
+
+		return NULL;
+	}
+
+	int next = 1;
+	Scop* scop = ParseScopRecords(ctx, &records, &next);
+	if (scop == NULL || next >= records.size()) {
+		FreeScop(scop);
+		if (!quiet) {
+			cout << "The scop snapshot is corrupt: " << fileName << endl;
+		}
+
+		return NULL;
+	}
+
+	*dependencesKey = records[next];
+	dependenceRecords->assign(records.begin() + next + 1, records.end());
+	return scop;
+}
+
+Scop* ParseScopRecords(isl_ctx* ctx, vector<string>* records, int* next) {
+	/* Reads the scop from the records that follow the version. NULL if a
+	record is missing or is not in the textual form of isl. */
+	if (*next + 4 > records->size()) {
+		return NULL;
+	}
+
+	Scop* scop = AllocateScop();
+	scop->context = SetFromString(ctx, records->at((*next)++));
+	scop->schedule = ScheduleFromString(ctx, records->at((*next)++));
+	scop->mayReads = UnionMapFromString(ctx, records->at((*next)++));
+	scop->mayWrites = UnionMapFromString(ctx, records->at((*next)++));
+	if (!scop->context || !scop->schedule || !scop->mayReads ||
+		!scop->mayWrites) {
+		FreeScop(scop);
+		return NULL;
+	}
+
+	int numArrays = 0;
+	if (!ParseRecordCount(records, next, &numArrays) ||
+		*next + numArrays > records->size()) {
+		FreeScop(scop);
+		return NULL;
+	}
+
+	for (int i = 0; i < numArrays; i++) {
+		isl_set* extent = SetFromString(ctx, records->at((*next)++));
+		if (extent == NULL) {
+			FreeScop(scop);
+			return NULL;
+		}
+
+		scop->arrayExtents->push_back(extent);
+	}
+
+	int numStatements = 0;
+	if (!ParseRecordCount(records, next, &numStatements) ||
+		*next + 2 * numStatements > records->size()) {
+		FreeScop(scop);
+		return NULL;
+	}
+
+	for (int i = 0; i < numStatements; i++) {
+		ScopStatement statement;
+		statement.domain = SetFromString(ctx, records->at((*next)++));
+		if (statement.domain == NULL) {
+			FreeScop(scop);
+			return NULL;
+		}
+
+		scop->statements->push_back(statement);
+		if (!ParseRecordCount(records, next, &scop->statements->back().flops)) {
+			FreeScop(scop);
+			return NULL;
+		}
+	}
+
+	return scop;
+}
+
+bool ParseRecordCount(vector<string>* records, int* next, int* count) {
+	if (*next >= records->size()) {
+		return false;
+	}
+
+	const char* record = records->at((*next)++).c_str();
+	char* end = NULL;
+	long value = strtol(record, &end, 10);
+	if (end == record || *end != '\0' || value < 0) {
+		return false;
+	}
+
+	*count = value;
+	return true;
+}
@@ -0,0 +1,16 @@
+#ifndef SCOP_SNAPSHOT_HPP
+#define SCOP_SNAPSHOT_HPP
+
+#include <Scop.hpp>
+#include <string>
+#include <vector>
+
+/* A file that holds a scop, as extracted by pet, and the data dependences
+computed on it, so that a later run can skip the front end. The dependences
+are stored under the key of the analysis cache they were computed for. */
+bool WriteScopSnapshot(std::string fileName, Scop* scop,
+	std::string dependencesKey, std::vector<std::string>* dependenceRecords);
+Scop* ReadScopSnapshot(isl_ctx* ctx, std::string fileName, bool quiet,
+	std::string* dependencesKey, std::vector<std::string>* dependenceRecords);
+
+#endif
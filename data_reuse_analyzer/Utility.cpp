@@ -268,3 +268,125 @@ void CollectArrayNames(isl_union_map *may_reads, isl_union_map *may_writes, vect
 	CollectArrayNamesFromUnionMap(may_reads, arrayNames);
 	CollectArrayNamesFromUnionMap(may_writes, arrayNames);
 }
+
+
+/* The following functions convert isl objects to and from their textual
+representation. They are used to move isl objects across isl contexts. A NULL
+object is represented by an empty string. */
+string ConvertIslStringToString(char* str) {
+	string result;
+	if (str) {
+		result = str;
+		free(str);
+	}
+
+	return result;
+}
+
+string BasicMapToString(isl_basic_map* map) {
+	if (map == NULL) {
+		return "";
+	}
+
+	return ConvertIslStringToString(isl_basic_map_to_str(map));
+}
+
+string SetToString(isl_set* set) {
+	if (set == NULL) {
+		return "";
+	}
+
+	return ConvertIslStringToString(isl_set_to_str(set));
+}
+
+string UnionMapToString(isl_union_map* map) {
+	if (map == NULL) {
+		return "";
+	}
+
+	return ConvertIslStringToString(isl_union_map_to_str(map));
+}
+
+string ScheduleToString(isl_schedule* schedule) {
+	if (schedule == NULL) {
+		return "";
+	}
+
+	return ConvertIslStringToString(isl_schedule_to_str(schedule));
+}
+
+string UnionPwQpolynomialToString(isl_union_pw_qpolynomial* poly) {
+	if (poly == NULL) {
+		return "";
+	}
+
+	return ConvertIslStringToString(isl_union_pw_qpolynomial_to_str(poly));
+}
+
+isl_basic_map* BasicMapFromString(isl_ctx* ctx, string str) {
+	if (str.empty()) {
+		return NULL;
+	}
+
+	return isl_basic_map_read_from_str(ctx, str.c_str());
+}
+
+isl_set* SetFromString(isl_ctx* ctx, string str) {
+	if (str.empty()) {
+		return NULL;
+	}
+
+	return isl_set_read_from_str(ctx, str.c_str());
+}
+
+isl_union_map* UnionMapFromString(isl_ctx* ctx, string str) {
+	if (str.empty()) {
+		return NULL;
+	}
+
+	return isl_union_map_read_from_str(ctx, str.c_str());
+}
+
+isl_schedule* ScheduleFromString(isl_ctx* ctx, string str) {
+	if (str.empty()) {
+		return NULL;
+	}
+
+	return isl_schedule_read_from_str(ctx, str.c_str());
+}
+
+isl_union_pw_qpolynomial* UnionPwQpolynomialFromString(isl_ctx* ctx, string str) {
+	if (str.empty()) {
+		return NULL;
+	}
+
+	return isl_union_pw_qpolynomial_read_from_str(ctx, str.c_str());
+}
+
+string ScopToString(Scop* scop) {
+	/* The textual form of the parts of the scop the analysis depends on */
+	string scopString = SetToString(scop->context) + "\n";
+	scopString += ScheduleToString(scop->schedule) + "\n";
+	scopString += UnionMapToString(scop->mayReads) + "\n";
+	scopString += UnionMapToString(scop->mayWrites) + "\n";
+
+	for (int i = 0; i < scop->arrayExtents->size(); i++) {
+		scopString += SetToString(scop->arrayExtents->at(i)) + "\n";
+	}
+
+	for (int i = 0; i < scop->statements->size(); i++) {
+		scopString += SetToString(scop->statements->at(i).domain) + "\n";
+	}
+
+	return scopString;
+}
+
+long ComputeGcd(long a, long b) {
+	while (b != 0) {
+		long t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a < 0 ? -a : a;
+}
@@ -2,6 +2,7 @@
 #define UTILITY_HPP
 
 #include <pet.h>
+#include <Scop.hpp>
 #include <isl/union_set.h>
 #include <isl/flow.h>
 #include <barvinok/isl.h>
@@ -28,4 +29,16 @@ void PrintConstraint(isl_constraint* constraint);
 void PrintMat(isl_mat* mat);
 void CollectArrayNames(isl_union_map *may_reads, isl_union_map *may_writes, vector<string>* arrayNames);
 void CollectArrayNamesFromUnionMap(isl_union_map* orig_map, vector<string>* arrayNames);
+string BasicMapToString(isl_basic_map* map);
+string SetToString(isl_set* set);
+string UnionMapToString(isl_union_map* map);
+string ScheduleToString(isl_schedule* schedule);
+string UnionPwQpolynomialToString(isl_union_pw_qpolynomial* poly);
+isl_basic_map* BasicMapFromString(isl_ctx* ctx, string str);
+isl_set* SetFromString(isl_ctx* ctx, string str);
+isl_union_map* UnionMapFromString(isl_ctx* ctx, string str);
+isl_schedule* ScheduleFromString(isl_ctx* ctx, string str);
+isl_union_pw_qpolynomial* UnionPwQpolynomialFromString(isl_ctx* ctx, string str);
+string ScopToString(Scop* scop);
+long ComputeGcd(long a, long b);
 #endif
\ No newline at end of file
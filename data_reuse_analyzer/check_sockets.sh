@@ -0,0 +1,37 @@
+#!/bin/sh
+# Checks that a machine of two sockets changes the L3 data set size of the
+# pessimistic model. The j loop of the matmul is split across 64 threads. On
+# one socket, the columns of B of all the threads, 24 MB, do not fit in the L3
+# cache of 16 MB. On two sockets, the L3 cache of each socket holds the half of
+# them read by its 32 threads.
+
+# The statistics are written next to the input, so that the input is copied
+# to a directory of its own, which is removed at the end.
+WORK_DIR=`mktemp -d` || exit 1
+trap 'rm -rf "$WORK_DIR"' EXIT
+cp ../apps/matmul.c "$WORK_DIR" || exit 1
+
+INPUT=$WORK_DIR/matmul.c
+STATS=${INPUT}_ws_stats.csv
+OPTIONS="--parallel_loops j --numprocs 64 --datatypesize 4"
+PARAMETERS="M N K : 1000 2000 3000"
+CACHES="L1 32768 L2 1048576 L3 16777216"
+
+./polyscientist --input $INPUT $OPTIONS --parameters "$PARAMETERS" \
+	--cachesizes "$CACHES" > /dev/null || exit 1
+ONE_SOCKET_L3=`sed -n 2p $STATS | cut -d, -f4`
+
+./polyscientist --input $INPUT $OPTIONS --parameters "$PARAMETERS" \
+	--cachesizes "$CACHES sockets 2 cores_per_socket 32" > /dev/null || exit 1
+TWO_SOCKETS_L3=`sed -n 2p $STATS | cut -d, -f4`
+SOCKET_L3_FIT=`sed -n 2p $STATS | cut -d, -f8`
+
+echo "L3 data set size: $ONE_SOCKET_L3 on one socket, $TWO_SOCKETS_L3 on two sockets"
+echo "Working sets in the L3 cache of a socket: $SOCKET_L3_FIT"
+
+if [ "$ONE_SOCKET_L3" = "$TWO_SOCKETS_L3" ]; then
+	echo "FAILED: the sockets do not change the L3 data set size"
+	exit 1
+fi
+
+echo "PASSED"